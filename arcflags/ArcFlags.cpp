@@ -0,0 +1,203 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <thread>
+#include "ArcFlags.h"
+#include "../pq/ExtrinsicMinPQ.h"
+
+/*
+ * Helper function running Dijkstra's from 'root', over outgoing arcs if
+ * 'forward' or incoming arcs otherwise. 'dist' receives the distances,
+ * infinity for unreachable vertices.
+*/
+static void flagSearch(const CompactDirectedGraph& graph, const int root,
+                       const bool forward, std::vector<double>* dist) {
+  std::fill(dist->begin(), dist->end(),
+            std::numeric_limits<double>::infinity());
+  ExtrinsicMinPQ<int> fringe;
+  fringe.add(root, 0.0);
+  (*dist)[root] = 0.0;
+
+  while (!fringe.isEmpty()) {
+    int* ptr = fringe.removeSmallest();
+    int u = *ptr;
+    delete ptr;
+    double d = (*dist)[u];
+
+    auto edges = forward ? graph.outgoingNeighbors(u)
+                         : graph.incomingNeighbors(u);
+    for (auto& edge : edges) {
+      int b = edgeTarget(edge);
+      double next = d + edgeWeight(edge);
+      if ((*dist)[b] == std::numeric_limits<double>::infinity()) {
+        fringe.add(b, next);
+        (*dist)[b] = next;
+      } else if (next < (*dist)[b]) {
+        fringe.changePriority(b, next);
+        (*dist)[b] = next;
+      }
+    }
+  }
+}
+
+/*
+ * Helper function telling whether 'shorter' + 'weight' equals 'longer',
+ * allowing for rounding errors in the sums.
+*/
+static bool isTight(const double shorter, const double weight,
+                    const double longer) {
+  if (longer == std::numeric_limits<double>::infinity())
+    return false;
+  return std::fabs(shorter + weight - longer) <=
+         1e-12 * std::max(1.0, longer);
+}
+
+/*
+ * Helper function setting the bits of 'mask' in a flag word shared by
+ * several threads; most words have them set already, so look first.
+*/
+static inline void setFlag(std::atomic<uint64_t>* flags, const uint64_t mask) {
+  if ((flags->load(std::memory_order_relaxed) & mask) != mask)
+    flags->fetch_or(mask, std::memory_order_relaxed);
+}
+
+inline ArcFlags::ArcFlags(const CompactDirectedGraph& graph,
+                          const GraphPartition& partition,
+                          const int numThreads) :
+                         graph_(graph), partition_(partition) {
+  const int V = graph.numVertices();
+
+  // Flags are collected in shared atomic arrays, so that memory does not
+  // grow with the number of threads.
+  const size_t numArcs = graph.numArcs();
+  std::unique_ptr<std::atomic<uint64_t>[]> forward(
+      new std::atomic<uint64_t>[numArcs]);
+  std::unique_ptr<std::atomic<uint64_t>[]> backward(
+      new std::atomic<uint64_t>[numArcs]);
+  for (size_t i = 0; i < numArcs; i++) {
+    forward[i].store(0, std::memory_order_relaxed);
+    backward[i].store(0, std::memory_order_relaxed);
+  }
+
+  // Intra-cell arcs are flagged for their own cell in both directions.
+  for (int u = 0; u < V; u++) {
+    uint64_t mask = 1ULL << partition.cell(u);
+    int i = graph.firstOutgoingArc(u);
+    for (auto& edge : graph.outgoingNeighbors(u)) {
+      if (partition.cell(edgeTarget(edge)) == partition.cell(u))
+        forward[i].fetch_or(mask, std::memory_order_relaxed);
+      i++;
+    }
+    i = graph.firstIncomingArc(u);
+    for (auto& edge : graph.incomingNeighbors(u)) {
+      if (partition.cell(edgeTarget(edge)) == partition.cell(u))
+        backward[i].fetch_or(mask, std::memory_order_relaxed);
+      i++;
+    }
+  }
+
+  // One task per boundary vertex and direction: a vertex entered from
+  // another cell bounds its cell for forward flags, a vertex with an arc
+  // leaving its cell bounds it for backward flags.
+  std::vector<std::pair<int, bool>> tasks;
+  for (int v = 0; v < V; v++) {
+    for (auto& edge : graph.incomingNeighbors(v)) {
+      if (partition.cell(edgeTarget(edge)) != partition.cell(v)) {
+        tasks.push_back(std::make_pair(v, true));
+        break;
+      }
+    }
+    for (auto& edge : graph.outgoingNeighbors(v)) {
+      if (partition.cell(edgeTarget(edge)) != partition.cell(v)) {
+        tasks.push_back(std::make_pair(v, false));
+        break;
+      }
+    }
+  }
+
+  int threads = numThreads > 0 ? numThreads
+                               : std::thread::hardware_concurrency();
+  threads = std::max(1, std::min(threads, static_cast<int>(tasks.size())));
+  std::atomic<size_t> nextTask(0);
+
+  auto work = [&]() {
+    std::vector<double> dist(V);
+
+    for (size_t task = nextTask++; task < tasks.size(); task = nextTask++) {
+      int b = tasks[task].first;
+      uint64_t mask = 1ULL << partition.cell(b);
+
+      if (tasks[task].second) {
+        // Distances to b: u => v is on a shortest path to b if
+        // dist(u) = w + dist(v).
+        flagSearch(graph, b, false, &dist);
+        for (int u = 0; u < V; u++) {
+          int i = graph.firstOutgoingArc(u);
+          for (auto& edge : graph.outgoingNeighbors(u)) {
+            if (isTight(dist[edgeTarget(edge)], edgeWeight(edge), dist[u]))
+              setFlag(&forward[i], mask);
+            i++;
+          }
+        }
+      } else {
+        // Distances from b: u => v is on a shortest path from b if
+        // dist(u) + w = dist(v).
+        flagSearch(graph, b, true, &dist);
+        for (int v = 0; v < V; v++) {
+          int i = graph.firstIncomingArc(v);
+          for (auto& edge : graph.incomingNeighbors(v)) {
+            if (isTight(dist[edgeTarget(edge)], edgeWeight(edge), dist[v]))
+              setFlag(&backward[i], mask);
+            i++;
+          }
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; t++)
+    pool.push_back(std::thread(work));
+  work();
+  for (auto& thread : pool)
+    thread.join();
+
+  forward_.resize(numArcs);
+  backward_.resize(numArcs);
+  for (size_t i = 0; i < numArcs; i++) {
+    forward_[i] = forward[i].load(std::memory_order_relaxed);
+    backward_[i] = backward[i].load(std::memory_order_relaxed);
+  }
+}
+
+inline double ArcFlags::forwardDensity() const {
+  if (forward_.empty())
+    return 0.0;
+  size_t set = 0;
+  for (auto& flags : forward_)
+    set += __builtin_popcountll(flags);
+  return static_cast<double>(set) /
+         (static_cast<double>(forward_.size()) * partition_.numCells());
+}
+
+inline FlaggedArcRange ArcFlagsView::outgoingNeighbors(const int& v) const {
+  const CompactDirectedGraph& graph = flags_.graph();
+  return FlaggedArcRange(graph.outgoingNeighbors(v),
+                         flags_.forward_.data() + graph.firstOutgoingArc(v),
+                         forwardMask);
+}
+
+inline FlaggedArcRange ArcFlagsView::incomingNeighbors(const int& v) const {
+  const CompactDirectedGraph& graph = flags_.graph();
+  return FlaggedArcRange(graph.incomingNeighbors(v),
+                         flags_.backward_.data() + graph.firstIncomingArc(v),
+                         backwardMask);
+}
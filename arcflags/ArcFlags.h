@@ -0,0 +1,166 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef ARCFLAGS_H_
+#define ARCFLAGS_H_
+
+#include <stdint.h>
+#include <vector>
+#include "GraphPartition.h"
+#include "../graph/CompactDirectedGraph.h"
+#include "../graph/StaticGraph.h"
+
+/*
+ * Arc-flags preprocessing for goal-directed pruning of shortest-path
+ * searches on a CompactDirectedGraph.
+ *
+ * For every arc and every cell C of a partition, the forward flag for C
+ * is set if the arc lies on some shortest path to a vertex in C, and the
+ * backward flag for C is set if it lies on some shortest path from a
+ * vertex in C. Flags are one 64-bit word per arc, kept in arrays parallel
+ * to the graph's outgoing and incoming arcs.
+ *
+ * Flags for cell C are found with one Dijkstra's per boundary vertex of C
+ * (vertices of C with an arc from/to another cell): every arc that is
+ * tight in its shortest path tree is flagged, as is every arc inside C.
+ * These searches are independent and run in parallel.
+ *
+ * The graph and partition must outlive the flags.
+*/
+class ArcFlags {
+ public:
+  /*
+   * Ctor.
+   * Computes the flags of 'graph' for 'partition', using 'numThreads'
+   * threads (or one per hardware thread if 0).
+  */
+  ArcFlags(const CompactDirectedGraph& graph,
+           const GraphPartition& partition, const int numThreads = 0);
+
+  /*
+   * Dtor.
+  */
+  ~ArcFlags() { }
+
+  /*
+   * Returns the graph/partition the flags were computed for.
+  */
+  const CompactDirectedGraph& graph() const { return graph_; }
+  const GraphPartition& partition() const { return partition_; }
+
+  /*
+   * Returns the flags of the outgoing arc with the given index; bit C is
+   * set if the arc lies on a shortest path to cell C.
+  */
+  uint64_t forwardFlags(const int arc) const { return forward_[arc]; }
+
+  /*
+   * Returns the flags of the incoming arc with the given index; bit C is
+   * set if the arc lies on a shortest path from cell C.
+  */
+  uint64_t backwardFlags(const int arc) const { return backward_[arc]; }
+
+  /*
+   * Returns the fraction of (arc, cell) forward flags that are set, i.e.
+   * roughly how much of the graph a forward search may still explore.
+  */
+  double forwardDensity() const;
+
+ private:
+  friend class ArcFlagsView;
+
+  const CompactDirectedGraph& graph_;
+  const GraphPartition& partition_;
+  std::vector<uint64_t> forward_;
+  std::vector<uint64_t> backward_;
+};
+
+/*
+ * Range over the arcs of an ArcRange whose flag has a given bit set.
+ * Iterating it skips all other arcs.
+*/
+class FlaggedArcRange {
+ public:
+  class Iterator {
+   public:
+    Iterator(const Arc<int>* arc, const Arc<int>* end,
+             const uint64_t* flags, const uint64_t mask) :
+            arc_(arc), end_(end), flags_(flags), mask_(mask) { skip(); }
+
+    const Arc<int>& operator*() const { return *arc_; }
+    Iterator& operator++() {
+      arc_++;
+      flags_++;
+      skip();
+      return *this;
+    }
+    bool operator!=(const Iterator& other) const { return arc_ != other.arc_; }
+
+   private:
+    void skip() {
+      while (arc_ != end_ && (*flags_ & mask_) == 0) {
+        arc_++;
+        flags_++;
+      }
+    }
+
+    const Arc<int>* arc_;
+    const Arc<int>* end_;
+    const uint64_t* flags_;
+    uint64_t mask_;
+  };
+
+  /*
+   * Ctor. 'flags' is parallel to 'arcs'.
+  */
+  FlaggedArcRange(const ArcRange<int>& arcs, const uint64_t* flags,
+                  const uint64_t mask) :
+                 arcs_(arcs), flags_(flags), mask_(mask) { }
+
+  Iterator begin() const {
+    return Iterator(arcs_.begin(), arcs_.end(), flags_, mask_);
+  }
+  Iterator end() const {
+    return Iterator(arcs_.end(), arcs_.end(), flags_ + arcs_.size(), mask_);
+  }
+
+ private:
+  ArcRange<int> arcs_;
+  const uint64_t* flags_;
+  uint64_t mask_;
+};
+
+/*
+ * View of a flagged graph for one (start, end) query: outgoing arcs are
+ * limited to those flagged for the end vertex's cell, and incoming arcs
+ * to those flagged for the start vertex's cell. Meets the requirements in
+ * "graph/StaticGraph.h", so e.g. BiDijkstraSolver<int, ArcFlagsView>
+ * searches it like any graph; every shortest path from start to end is
+ * still present in both directions.
+*/
+class ArcFlagsView {
+ public:
+  /*
+   * Ctor.
+   * The flags must outlive the view.
+  */
+  ArcFlagsView(const ArcFlags& flags, const int start, const int end) :
+              flags_(flags),
+              forwardMask(1ULL << flags.partition().cell(end)),
+              backwardMask(1ULL << flags.partition().cell(start)) { }
+
+  FlaggedArcRange outgoingNeighbors(const int& v) const;
+  FlaggedArcRange incomingNeighbors(const int& v) const;
+
+ private:
+  const ArcFlags& flags_;
+  uint64_t forwardMask;
+  uint64_t backwardMask;
+};
+
+#include "ArcFlags.cpp"
+
+#endif  // ARCFLAGS_H_
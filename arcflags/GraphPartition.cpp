@@ -0,0 +1,154 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <algorithm>
+#include <deque>
+#include "GraphPartition.h"
+
+/*
+ * Helper function running a breadth-first search from all of 'sources'
+ * at once, over edges in either direction. 'hops' receives each vertex's
+ * number of edges from the nearest source, or -1 if it is unreachable.
+*/
+template <typename GraphType>
+static void undirectedBFS(const GraphType& graph,
+                          const std::vector<int>& sources,
+                          std::vector<int>* hops) {
+  std::fill(hops->begin(), hops->end(), -1);
+  std::deque<int> queue;
+  for (auto& s : sources) {
+    (*hops)[s] = 0;
+    queue.push_back(s);
+  }
+  while (!queue.empty()) {
+    int u = queue.front();
+    queue.pop_front();
+    for (auto& edge : graph.outgoingNeighbors(u)) {
+      int v = edgeTarget(edge);
+      if ((*hops)[v] == -1) {
+        (*hops)[v] = (*hops)[u] + 1;
+        queue.push_back(v);
+      }
+    }
+    for (auto& edge : graph.incomingNeighbors(u)) {
+      int v = edgeTarget(edge);
+      if ((*hops)[v] == -1) {
+        (*hops)[v] = (*hops)[u] + 1;
+        queue.push_back(v);
+      }
+    }
+  }
+}
+
+inline GraphPartition::GraphPartition(const std::vector<int>& cells,
+                                     const int k) :
+                                    cells_(cells), valid_(true) {
+  k_ = std::max(1, std::min(k, +kMaxCells));
+  for (auto& c : cells_) {
+    if (c < 0 || c >= k_)
+      valid_ = false;
+  }
+  if (!valid_) {
+    cells_.assign(cells.size(), 0);
+    k_ = 1;
+  }
+}
+
+template <typename GraphType>
+GraphPartition::GraphPartition(const GraphType& graph, const int V,
+                               const int k) : valid_(true) {
+  k_ = std::max(1, std::min(std::min(k, +kMaxCells), V));
+  cells_.assign(V, -1);
+  if (V == 0)
+    return;
+
+  // Pick seeds one by one, each the furthest from the previous ones
+  // (vertices unreachable from all of them first).
+  std::vector<int> seeds(1, 0);
+  std::vector<int> hops(V);
+  while (static_cast<int>(seeds.size()) < k_) {
+    undirectedBFS(graph, seeds, &hops);
+    int furthest = -1;
+    for (int v = 0; v < V; v++) {
+      if (hops[v] == -1) {
+        furthest = v;
+        break;
+      }
+      if (furthest == -1 || hops[v] > hops[furthest])
+        furthest = v;
+    }
+    seeds.push_back(furthest);
+  }
+
+  // Grow the regions in turns, one vertex at a time, up to capacity.
+  int capacity = (V + k_ - 1) / k_;
+  std::vector<int> sizes(k_, 0);
+  std::vector<std::deque<int>> frontiers(k_);
+  for (int c = 0; c < k_; c++)
+    frontiers[c].push_back(seeds[c]);
+  bool grew = true;
+  while (grew) {
+    grew = false;
+    for (int c = 0; c < k_; c++) {
+      std::deque<int>& frontier = frontiers[c];
+      while (!frontier.empty() && cells_[frontier.front()] != -1)
+        frontier.pop_front();
+      if (sizes[c] >= capacity || frontier.empty())
+        continue;
+
+      int u = frontier.front();
+      frontier.pop_front();
+      cells_[u] = c;
+      sizes[c]++;
+      grew = true;
+      for (auto& edge : graph.outgoingNeighbors(u)) {
+        if (cells_[edgeTarget(edge)] == -1)
+          frontier.push_back(edgeTarget(edge));
+      }
+      for (auto& edge : graph.incomingNeighbors(u)) {
+        if (cells_[edgeTarget(edge)] == -1)
+          frontier.push_back(edgeTarget(edge));
+      }
+    }
+  }
+
+  // Vertices cut off by full cells join a neighboring cell...
+  std::deque<int> queue;
+  for (int v = 0; v < V; v++) {
+    if (cells_[v] != -1)
+      queue.push_back(v);
+  }
+  while (!queue.empty()) {
+    int u = queue.front();
+    queue.pop_front();
+    for (auto& edge : graph.outgoingNeighbors(u)) {
+      int v = edgeTarget(edge);
+      if (cells_[v] == -1) {
+        cells_[v] = cells_[u];
+        sizes[cells_[v]]++;
+        queue.push_back(v);
+      }
+    }
+    for (auto& edge : graph.incomingNeighbors(u)) {
+      int v = edgeTarget(edge);
+      if (cells_[v] == -1) {
+        cells_[v] = cells_[u];
+        sizes[cells_[v]]++;
+        queue.push_back(v);
+      }
+    }
+  }
+
+  // ...and the rest of disconnected components fill the smallest cells.
+  for (int v = 0; v < V; v++) {
+    if (cells_[v] == -1) {
+      int smallest = std::min_element(sizes.begin(), sizes.end()) -
+                     sizes.begin();
+      cells_[v] = smallest;
+      sizes[smallest]++;
+    }
+  }
+}
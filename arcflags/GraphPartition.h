@@ -0,0 +1,79 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef GRAPHPARTITION_H_
+#define GRAPHPARTITION_H_
+
+#include <vector>
+#include "../graph/StaticGraph.h"
+
+/*
+ * Partition of a graph's vertices (of primitive type 'int', from 0 to
+ * V - 1) into at most 64 cells, numbered from 0.
+ *
+ * The partitioner grows balanced regions: it picks spread-out seed
+ * vertices (each the furthest, in hops, from the seeds picked before it),
+ * then grows one region per seed breadth-first over edges in either
+ * direction, taking turns, until every cell holds ceil(V / k) vertices.
+ * Cells therefore tend to be connected and compact, with few boundary
+ * vertices, which is what arc-flags preprocessing benefits from.
+*/
+class GraphPartition {
+ public:
+  /*
+   * Maximum number of cells, so that one bit per cell fits a word.
+  */
+  static const int kMaxCells = 64;
+
+  /*
+   * Ctor.
+   * Partitions 'graph', which has 'V' vertices, into 'k' cells. 'k' is
+   * clamped to between 1 and kMaxCells.
+   *
+   * Read "graph/StaticGraph.h" for the requirements on 'GraphType'.
+  */
+  template <typename GraphType>
+  GraphPartition(const GraphType& graph, const int V, const int k);
+
+  /*
+   * Ctor.
+   * Uses a precomputed partition: 'cells' holds each vertex's cell,
+   * from 0 to 'k' - 1. 'k' is clamped to between 1 and kMaxCells. If a
+   * cell is out of that range, the partition is rejected: valid() returns
+   * false and all vertices are put in cell 0, which keeps arc flags
+   * correct (but useless).
+  */
+  GraphPartition(const std::vector<int>& cells, const int k);
+
+  /*
+   * Dtor.
+  */
+  ~GraphPartition() { }
+
+  /*
+   * Returns the number of cells.
+  */
+  int numCells() const { return k_; }
+
+  /*
+   * Returns the cell of the given vertex.
+  */
+  int cell(const int v) const { return cells_[v]; }
+
+  /*
+   * Returns false if the partition given to the ctor was rejected.
+  */
+  bool valid() const { return valid_; }
+
+ private:
+  std::vector<int> cells_;
+  int k_;
+  bool valid_;
+};
+
+#include "GraphPartition.cpp"
+
+#endif  // GRAPHPARTITION_H_
@@ -0,0 +1,125 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <assert.h>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "ArcFlags.h"
+#include "GraphPartition.h"
+#include "../graph/CompactDirectedGraph.h"
+#include "../solver/BiDijkstraSolver.h"
+
+int main(int argc, char* argv[]) {
+  /*
+  ////////////////// Small graph. //////////////////
+  */
+  WeightedDirectedGraph wdg(7);
+  wdg.addEdge(0, 1, 2);
+  wdg.addEdge(0, 2, 1);
+  wdg.addEdge(1, 2, 5);
+  wdg.addEdge(1, 3, 11);
+  wdg.addEdge(1, 4, 3);
+  wdg.addEdge(2, 5, 15);
+  wdg.addEdge(3, 4, 2);
+  wdg.addEdge(4, 2, 1);
+  wdg.addEdge(4, 5, 4);
+  wdg.addEdge(4, 6, 5);
+  wdg.addEdge(6, 3, 1);
+  wdg.addEdge(6, 5, 1);
+  CompactDirectedGraph cdg(wdg);
+
+  static_assert(IsStaticGraph<ArcFlagsView, int>::value,
+                "ArcFlagsView must be usable by the solvers.");
+
+  // Cells {0, 1, 2} and {3, 4, 5, 6}.
+  GraphPartition small(std::vector<int>({0, 0, 0, 1, 1, 1, 1}), 2);
+  assert(small.valid() && 2 == small.numCells());
+
+  // Cells out of range are rejected.
+  GraphPartition outOfRange(std::vector<int>({0, 0, 0, 1, 1, 1, 2}), 2);
+  assert(!outOfRange.valid() && 1 == outOfRange.numCells());
+  assert(0 == outOfRange.cell(6));
+  GraphPartition negative(std::vector<int>({0, 0, 0, 1, 1, 1, -1}), 2);
+  assert(!negative.valid());
+  GraphPartition tooMany(std::vector<int>({0, 0, 0, 1, 1, 1, 64}), 100);
+  assert(!tooMany.valid() && 1 == tooMany.numCells());
+  ArcFlags smallFlags(cdg, small, 2);
+  int arc = cdg.firstOutgoingArc(1);  // 1 => 2, inside cell 0.
+  assert(2 == cdg.outgoingNeighbors(1).begin()->to);
+  assert(1 == smallFlags.forwardFlags(arc));
+  arc++;                              // 1 => 3, never on a shortest path.
+  assert(3 == (cdg.outgoingNeighbors(1).begin() + 1)->to);
+  assert(0 == smallFlags.forwardFlags(arc));
+  assert(0 == smallFlags.backwardFlags(cdg.firstIncomingArc(3)));
+
+  for (int s = 0; s < 7; s++) {
+    for (int t = 0; t < 7; t++) {
+      BiDijkstraSolver<int, CompactDirectedGraph> plain(cdg, s, t, 10);
+      ArcFlagsView view(smallFlags, s, t);
+      BiDijkstraSolver<int, ArcFlagsView> flagged(view, s, t, 10);
+      assert(plain.outcome() == flagged.outcome());
+      if (plain.outcome() == 1)
+        assert(plain.solutionWeight() == flagged.solutionWeight());
+    }
+  }
+
+  /*
+  ////////////////// Grid graph. //////////////////
+  */
+  const int side = 24, V = side * side;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> weight(1.0, 100.0);
+  WeightedDirectedGraph grid(V);
+  for (int r = 0; r < side; r++) {
+    for (int c = 0; c < side; c++) {
+      int v = r * side + c;
+      if (c + 1 < side) {
+        grid.addEdge(v, v + 1, weight(rng));
+        grid.addEdge(v + 1, v, weight(rng));
+      }
+      if (r + 1 < side) {
+        grid.addEdge(v, v + side, weight(rng));
+        grid.addEdge(v + side, v, weight(rng));
+      }
+    }
+  }
+  CompactDirectedGraph graph(grid);
+
+  GraphPartition partition(graph, V, 8);
+  assert(8 == partition.numCells());
+  std::vector<int> sizes(8, 0);
+  for (int v = 0; v < V; v++) {
+    assert(partition.cell(v) >= 0 && partition.cell(v) < 8);
+    sizes[partition.cell(v)]++;
+  }
+  for (auto& size : sizes)
+    assert(size > 0);
+
+  ArcFlags flags(graph, partition, 4);
+  ArcFlags serialFlags(graph, partition, 1);
+  for (int i = 0; i < graph.numArcs(); i++) {
+    assert(flags.forwardFlags(i) == serialFlags.forwardFlags(i));
+    assert(flags.backwardFlags(i) == serialFlags.backwardFlags(i));
+  }
+
+  long plainStates = 0, flaggedStates = 0;
+  for (int q = 0; q < 200; q++) {
+    int s = (q * 7919) % V, t = (q * 104729 + 13) % V;
+    BiDijkstraSolver<int, CompactDirectedGraph> plain(graph, s, t, 10);
+    ArcFlagsView view(flags, s, t);
+    BiDijkstraSolver<int, ArcFlagsView> flagged(view, s, t, 10);
+    assert(plain.outcome() == flagged.outcome());
+    assert(std::fabs(plain.solutionWeight() - flagged.solutionWeight()) <
+           1e-9);
+    plainStates += plain.numStatesExplored();
+    flaggedStates += flagged.numStatesExplored();
+  }
+  std::cout << "Flag density: " << flags.forwardDensity() << std::endl;
+  std::cout << "States explored: " << plainStates << " plain, "
+            << flaggedStates << " with arc flags." << std::endl;
+}
@@ -0,0 +1,150 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef COMPACTDIRECTEDGRAPH_H_
+#define COMPACTDIRECTEDGRAPH_H_
+
+#include <vector>
+#include "Coordinates.h"
+#include "HugePages.h"
+#include "StaticGraph.h"
+#include "WeightedDirectedGraph.h"
+#include "WeightedEdge.h"
+
+/*
+ * Read-only weighted directed graph stored in compressed sparse row form.
+ * Each vertex is of primitive type 'int', from 0 to V - 1.
+ *
+ * All outgoing arcs live in one contiguous array, sorted by source
+ * vertex; vertex v's arcs are those between offsets v and v + 1 (and
+ * likewise for incoming arcs). Neighbors are returned as an ArcRange,
+ * without virtual calls or pointer chasing, so searching this graph
+ * with e.g. BiDijkstraSolver<int, CompactDirectedGraph> lets the
+ * compiler inline adjacency access in the solver's hot loop.
+ *
+ * The arrays are allocated with HugePageAllocator, so they are backed by
+ * transparent huge pages if enabled (see "HugePages.h") when the graph
+ * is built or copied. A copy made on a given NUMA node lives on it.
+*/
+class CompactDirectedGraph {
+ public:
+  /*
+   * Ctor.
+   * Builds the graph from 'V' vertices and the given edges.
+  */
+  CompactDirectedGraph(const int V, const vector<WeightedEdge<int>>& edges) {
+    build(V, edges);
+  }
+
+  /*
+   * Ctor.
+   * Copies the given (virtual interface) graph.
+  */
+  explicit CompactDirectedGraph(const WeightedDirectedGraph& graph) {
+    vector<WeightedEdge<int>> edges;
+    for (int v = 0; v < graph.numVertices(); v++) {
+      for (auto& edge : graph.outgoingNeighbors(v))
+        edges.push_back(*edge);
+    }
+    build(graph.numVertices(), edges);
+  }
+
+  /*
+   * Dtor.
+  */
+  ~CompactDirectedGraph() { }
+
+  /*
+   * Returns the range of outgoing arcs from the given vertex.
+  */
+  ArcRange<int> outgoingNeighbors(const int& v) const {
+    return ArcRange<int>(outgoingArcs.data() + outgoingOffsets[v],
+                         outgoingArcs.data() + outgoingOffsets[v + 1]);
+  }
+
+  /*
+   * Returns the range of incoming arcs to the given vertex. Each arc's
+   * target is the vertex it comes from.
+  */
+  ArcRange<int> incomingNeighbors(const int& v) const {
+    return ArcRange<int>(incomingArcs.data() + incomingOffsets[v],
+                         incomingArcs.data() + incomingOffsets[v + 1]);
+  }
+
+  /*
+   * Returns the index of the given vertex's first outgoing (or incoming)
+   * arc. A vertex's arcs are numbered consecutively from there, in the
+   * order its neighbor range returns them, so per-arc data can be kept
+   * in arrays parallel to the adjacency.
+  */
+  int firstOutgoingArc(const int& v) const { return outgoingOffsets[v]; }
+  int firstIncomingArc(const int& v) const { return incomingOffsets[v]; }
+
+  /*
+   * Returns the number of vertices/arcs in the graph.
+  */
+  int numVertices() const { return outgoingOffsets.size() - 1; }
+  int numArcs() const { return outgoingArcs.size(); }
+
+  /*
+   * Attaches vertex coordinates to the graph, replacing any previous ones.
+   * Returns false (attaching nothing) unless there is one per vertex.
+  */
+  bool setCoordinates(const Coordinates& coordinates) {
+    if (coordinates.size() != numVertices())
+      return false;
+    coordinates_ = coordinates;
+    return true;
+  }
+
+  /*
+   * Returns the graph's vertex coordinates, or nullptr if it has none.
+  */
+  const Coordinates* coordinates() const {
+    return coordinates_.size() > 0 ? &coordinates_ : nullptr;
+  }
+
+ private:
+  template <typename T> using Array = vector<T, HugePageAllocator<T>>;
+
+  Array<int> outgoingOffsets;  // V + 1 offsets into 'outgoingArcs'.
+  Array<Arc<int>> outgoingArcs;
+  Array<int> incomingOffsets;  // V + 1 offsets into 'incomingArcs'.
+  Array<Arc<int>> incomingArcs;
+  Coordinates coordinates_;  // Optional; empty if not set.
+
+  /*
+   * Fills the arrays using a counting sort of 'edges' by source (and
+   * by target for the incoming arcs). Keeps the edges' relative order.
+  */
+  void build(const int V, const vector<WeightedEdge<int>>& edges) {
+    outgoingOffsets.assign(V + 1, 0);
+    incomingOffsets.assign(V + 1, 0);
+    for (auto& edge : edges) {
+      outgoingOffsets[edge.from() + 1]++;
+      incomingOffsets[edge.to() + 1]++;
+    }
+    for (int v = 0; v < V; v++) {
+      outgoingOffsets[v + 1] += outgoingOffsets[v];
+      incomingOffsets[v + 1] += incomingOffsets[v];
+    }
+
+    outgoingArcs.resize(edges.size());
+    incomingArcs.resize(edges.size());
+    vector<int> outgoingNext(outgoingOffsets.begin(),
+                             outgoingOffsets.end() - 1);
+    vector<int> incomingNext(incomingOffsets.begin(),
+                             incomingOffsets.end() - 1);
+    for (auto& edge : edges) {
+      Arc<int> out = {edge.to(), edge.weight()};
+      Arc<int> in = {edge.from(), edge.weight()};
+      outgoingArcs[outgoingNext[edge.from()]++] = out;
+      incomingArcs[incomingNext[edge.to()]++] = in;
+    }
+  }
+};
+
+#endif  // COMPACTDIRECTEDGRAPH_H_
@@ -0,0 +1,112 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef COORDINATES_H_
+#define COORDINATES_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "StaticGraph.h"
+
+/*
+ * Positions of a graph's vertices (of primitive type 'int', from 0 to
+ * V - 1), stored as one array per axis.
+ *
+ * With the Euclidean metric, (x, y) are plane coordinates. With the
+ * haversine metric, x is the longitude and y the latitude, in degrees,
+ * and distances are great-circle distances in meters.
+ *
+ * Used by BiDijkstraSolver's A* mode: if no edge is faster than some
+ * maximum speed, i.e. no edge weighs less than the distance between its
+ * endpoints divided by that speed, then distance / speed never
+ * overestimates the weight of a path.
+*/
+class Coordinates {
+ public:
+  enum Metric { kEuclidean, kHaversine };
+
+  /*
+   * Ctor.
+   * 'xs' and 'ys' hold the vertices' coordinates, in vertex order. If
+   * their sizes differ, no vertex gets coordinates (size() is 0), so
+   * that no graph accepts them.
+  */
+  Coordinates(const std::vector<float>& xs, const std::vector<float>& ys,
+              const Metric metric = kEuclidean) :
+             xs_(xs), ys_(ys), metric_(metric) {
+    if (xs_.size() != ys_.size()) {
+      xs_.clear();
+      ys_.clear();
+    }
+  }
+
+  /*
+   * Ctor.
+   * No coordinates.
+  */
+  Coordinates() : metric_(kEuclidean) { }
+
+  /*
+   * Dtor.
+  */
+  ~Coordinates() { }
+
+  /*
+   * Returns the number of vertices with coordinates.
+  */
+  int size() const { return xs_.size(); }
+
+  Metric metric() const { return metric_; }
+  float x(const int v) const { return xs_[v]; }
+  float y(const int v) const { return ys_[v]; }
+
+  /*
+   * Returns the distance between the given vertices.
+  */
+  double distance(const int u, const int v) const {
+    if (metric_ == kEuclidean)
+      return std::hypot(static_cast<double>(xs_[u]) - xs_[v],
+                        static_cast<double>(ys_[u]) - ys_[v]);
+
+    const double kEarthRadius = 6371000.0;
+    const double kRadians = 3.14159265358979323846 / 180.0;
+    double dLat = (static_cast<double>(ys_[v]) - ys_[u]) * kRadians;
+    double dLon = (static_cast<double>(xs_[v]) - xs_[u]) * kRadians;
+    double a = std::sin(dLat / 2) * std::sin(dLat / 2) +
+               std::cos(ys_[u] * kRadians) * std::cos(ys_[v] * kRadians) *
+               std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2 * kEarthRadius * std::asin(std::min(1.0, std::sqrt(a)));
+  }
+
+  /*
+   * Returns the maximum speed (distance per unit of weight) over all
+   * edges of 'graph'; infinity if some edge of positive length weighs
+   * nothing. Must be recomputed if any edge becomes faster; edges
+   * becoming slower keep it valid.
+   *
+   * Read "graph/StaticGraph.h" for the requirements on 'GraphType'.
+  */
+  template <typename GraphType>
+  double maxSpeed(const GraphType& graph) const {
+    double speed = 0.0;
+    for (int u = 0; u < size(); u++) {
+      for (auto& edge : graph.outgoingNeighbors(u)) {
+        double length = distance(u, edgeTarget(edge));
+        if (length > 0.0)
+          speed = std::max(speed, length / edgeWeight(edge));
+      }
+    }
+    return speed;
+  }
+
+ private:
+  std::vector<float> xs_;
+  std::vector<float> ys_;
+  Metric metric_;
+};
+
+#endif  // COORDINATES_H_
@@ -9,6 +9,7 @@
 
 #include <memory>
 #include <vector>
+#include "StaticGraph.h"
 #include "WeightedEdge.h"
 
 using std::unique_ptr;
@@ -22,6 +23,10 @@ using std::vector;
  *
  * Class with pure virtual functions. Cannot instantiate an object
  * of this class; meant for deriving subclasses.
+ *
+ * This is the virtual-dispatch way of providing a graph to the solvers.
+ * Read "StaticGraph.h" for graphs whose adjacency access the solvers
+ * can resolve at compile time.
 */
 template <typename Vertex> class Graph {
  public:
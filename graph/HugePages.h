@@ -0,0 +1,142 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef HUGEPAGES_H_
+#define HUGEPAGES_H_
+
+#include <stddef.h>
+#include <sys/mman.h>
+#include <atomic>
+#include <new>  // For bad_alloc
+
+/*
+ * Support for backing large arrays with transparent huge pages (THP).
+ *
+ * Large arrays allocated through HugePageAllocator get their own
+ * anonymous mapping, aligned to the huge page size. By default the
+ * mapping gets no advice, so the system's THP setting applies. When huge
+ * pages are forced on (see setHugePageMode()), the mapping is advised
+ * with madvise(MADV_HUGEPAGE) before it is first touched, so the kernel
+ * can back it with 2 MiB pages and the TLB covers 512 times more of it.
+ * On kernels without THP, the advice is simply ignored and regular pages
+ * are used. When forced off, it is advised with MADV_NOHUGEPAGE instead,
+ * so that it really gets regular pages even if THP is set to "always"
+ * (e.g. for a baseline to compare against).
+ *
+ * Since pages are only placed on first touch, arrays allocated and filled
+ * by a thread running on a given NUMA node also end up on that node.
+*/
+
+/*
+ * Size of a (2 MiB) huge page; smaller arrays use the regular heap.
+*/
+static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+/*
+ * What to advise for huge page mappings.
+*/
+enum HugePageMode {
+  kHugePagesDefault = 0,  // No advice: the system's THP setting applies.
+  kHugePagesOn = 1,       // MADV_HUGEPAGE.
+  kHugePagesOff = 2       // MADV_NOHUGEPAGE.
+};
+
+/*
+ * Process-wide setting for the advice, kHugePagesDefault unless changed.
+ * Only affects arrays allocated after the call.
+*/
+inline std::atomic<int>& hugePageModeFlag() {
+  static std::atomic<int> mode(kHugePagesDefault);
+  return mode;
+}
+inline void setHugePageMode(const HugePageMode mode) {
+  hugePageModeFlag() = mode;
+}
+inline HugePageMode hugePageMode() {
+  return static_cast<HugePageMode>(hugePageModeFlag().load());
+}
+
+/*
+ * Maps 'bytes' (rounded up to whole huge pages) of anonymous memory
+ * aligned to kHugePageSize, advised as set by setHugePageMode().
+ * Returns nullptr on failure.
+*/
+inline void* mapHugePages(const size_t bytes) {
+  size_t size = (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  size_t padded = size + kHugePageSize;
+  void* mapping = mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED)
+    return nullptr;
+
+  // Trim the padding so that the rest starts on a huge page boundary.
+  char* begin = static_cast<char*>(mapping);
+  char* aligned = reinterpret_cast<char*>(
+      (reinterpret_cast<size_t>(begin) + kHugePageSize - 1) /
+      kHugePageSize * kHugePageSize);
+  if (aligned > begin)
+    munmap(begin, aligned - begin);
+  if (begin + padded > aligned + size)
+    munmap(aligned + size, begin + padded - (aligned + size));
+
+#ifdef MADV_HUGEPAGE
+  if (hugePageMode() == kHugePagesOn)
+    madvise(aligned, size, MADV_HUGEPAGE);
+  else if (hugePageMode() == kHugePagesOff)
+    madvise(aligned, size, MADV_NOHUGEPAGE);
+#endif
+  return aligned;
+}
+
+/*
+ * Unmaps memory returned by mapHugePages('bytes').
+*/
+inline void unmapHugePages(void* data, const size_t bytes) {
+  size_t size = (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  munmap(data, size);
+}
+
+/*
+ * Allocator for std::vector and the like: arrays of at least one huge
+ * page get an aligned mapping of their own (see above), smaller ones come
+ * from the regular heap.
+*/
+template <typename T> class HugePageAllocator {
+ public:
+  typedef T value_type;
+
+  HugePageAllocator() { }
+  template <typename U> HugePageAllocator(const HugePageAllocator<U>&) { }
+
+  T* allocate(const size_t n) {
+    size_t bytes = n * sizeof(T);
+    if (bytes < kHugePageSize)
+      return static_cast<T*>(::operator new(bytes));
+    void* data = mapHugePages(bytes);
+    if (data == nullptr)
+      throw std::bad_alloc();
+    return static_cast<T*>(data);
+  }
+
+  void deallocate(T* data, const size_t n) {
+    size_t bytes = n * sizeof(T);
+    if (bytes < kHugePageSize)
+      ::operator delete(data);
+    else
+      unmapHugePages(data, bytes);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+  return true;
+}
+template <typename T, typename U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+  return false;
+}
+
+#endif  // HUGEPAGES_H_
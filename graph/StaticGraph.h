@@ -0,0 +1,102 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef STATICGRAPH_H_
+#define STATICGRAPH_H_
+
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "WeightedEdge.h"
+
+/*
+ * The solvers are templated on the type of graph they search, so that
+ * adjacency access can be resolved (and inlined) at compile time instead
+ * of going through the virtual functions of 'Graph'.
+ *
+ * Any class can be searched as long as it provides, for a vertex 'v':
+ *
+ *   outgoingNeighbors(v) const
+ *   incomingNeighbors(v) const
+ *
+ * each returning a range (anything usable in a range-based for loop)
+ * whose elements can be passed to edgeTarget() and edgeWeight() below.
+ * As with 'Graph', the target of an incoming edge is the vertex it comes
+ * from. 'Graph' itself (ranges of unique_ptr's to WeightedEdge's) is one
+ * such class; lightweight graphs can instead return an ArcRange.
+*/
+
+/*
+ * A lightweight edge: only its target vertex and its weight.
+*/
+template <typename Vertex> struct Arc {
+  Vertex to;
+  double weight;
+};
+
+/*
+ * A non-owning view of contiguous Arc's, e.g. one vertex's slice of a
+ * compressed adjacency array.
+*/
+template <typename Vertex> class ArcRange {
+ public:
+  ArcRange(const Arc<Vertex>* begin, const Arc<Vertex>* end) :
+          begin_(begin), end_(end) { }
+
+  const Arc<Vertex>* begin() const { return begin_; }
+  const Arc<Vertex>* end() const { return end_; }
+  int size() const { return end_ - begin_; }
+
+ private:
+  const Arc<Vertex>* begin_;
+  const Arc<Vertex>* end_;
+};
+
+/*
+ * Returns the target vertex of an element of a neighbor range.
+*/
+template <typename Vertex>
+inline Vertex edgeTarget(const std::unique_ptr<WeightedEdge<Vertex>>& edge) {
+  return edge->to();
+}
+template <typename Vertex>
+inline Vertex edgeTarget(const Arc<Vertex>& arc) { return arc.to; }
+
+/*
+ * Returns the weight of an element of a neighbor range.
+*/
+template <typename Vertex>
+inline double edgeWeight(const std::unique_ptr<WeightedEdge<Vertex>>& edge) {
+  return edge->weight();
+}
+template <typename Vertex>
+inline double edgeWeight(const Arc<Vertex>& arc) { return arc.weight; }
+
+/*
+ * Compile-time check that 'GraphType' meets the requirements above for
+ * vertices of type 'Vertex'. The solvers static_assert on it, so a
+ * mismatching graph fails with a readable message.
+*/
+template <typename GraphType, typename Vertex> class IsStaticGraph {
+ private:
+  template <typename G> static auto check(int) -> decltype(
+      edgeTarget(*std::begin(std::declval<const G&>().outgoingNeighbors(
+                                        std::declval<const Vertex&>()))),
+      edgeWeight(*std::begin(std::declval<const G&>().outgoingNeighbors(
+                                        std::declval<const Vertex&>()))),
+      edgeTarget(*std::begin(std::declval<const G&>().incomingNeighbors(
+                                        std::declval<const Vertex&>()))),
+      edgeWeight(*std::begin(std::declval<const G&>().incomingNeighbors(
+                                        std::declval<const Vertex&>()))),
+      std::true_type());
+  template <typename G> static std::false_type check(...);
+
+ public:
+  static const bool value = decltype(check<GraphType>(0))::value;
+};
+
+#endif  // STATICGRAPH_H_
@@ -57,6 +57,11 @@ class WeightedDirectedGraph: public Graph<int> {
     return incoming[v];
   }
 
+  /*
+   * Returns the number of vertices in the graph.
+  */
+  int numVertices() const { return outgoing.size(); }
+
   /*
    * Adds an edge to the graph. Populates both underlying vectors
    * accordingly. Arguments:
@@ -5,10 +5,16 @@
 */
 
 #include <assert.h>
+#include <cmath>
 #include <vector>
 #include <iostream>
+#include "CompactDirectedGraph.h"
+#include "Coordinates.h"
 #include "WeightedDirectedGraph.h"
 #include "../solver/BiDijkstraSolver.h"
+#include "../solver/AlternativeRouteSolver.h"
+#include "../solver/KShortestPathsSolver.h"
+#include "../solver/ShortestPathSession.h"
 
 int main(int argc, char* argv[]) {
   /*
@@ -60,4 +66,341 @@ int main(int argc, char* argv[]) {
   std::cout << "States explored: " << solver.numStatesExplored() << std::endl;
   std::cout << "Total time: " << solver.explorationTime();
   std::cout << "(seconds)" << std::endl;
+
+  assert(1 == solver.outcome());
+  assert(std::vector<int>({0, 1, 4, 6}) == solver.solution());
+  assert(10 == solver.solutionWeight());
+
+  // The path can be copied into a caller's buffer, with edge weights.
+  int vertices[8];
+  double weights[7];
+  assert(4 == solver.solutionSize());
+  assert(4 == solver.copySolution(vertices, weights, 3));  // Too small.
+  assert(4 == solver.copySolution(vertices, weights, 8));
+  assert(std::vector<int>({0, 1, 4, 6}) ==
+         std::vector<int>(vertices, vertices + 4));
+  assert(std::vector<double>({2, 3, 5}) ==
+         std::vector<double>(weights, weights + 3));
+
+  // Likewise before the vector is built, and without knowing the size.
+  BiDijkstraSolver<int> unbuilt(wdg, 0, 6, 10);
+  assert(4 == unbuilt.copySolution(vertices, nullptr, 2));
+  assert(4 == unbuilt.solutionSize());
+  BiDijkstraSolver<int> unsized(wdg, 0, 6, 10);
+  assert(4 == unsized.copySolution(vertices, weights, 8));
+  assert(std::vector<int>({0, 1, 4, 6}) ==
+         std::vector<int>(vertices, vertices + 4));
+  assert(std::vector<double>({2, 3, 5}) ==
+         std::vector<double>(weights, weights + 3));
+
+  BiDijkstraSolver<int> distanceOnly(wdg, 0, 6, 10, true);
+  assert(1 == distanceOnly.outcome());
+  assert(10 == distanceOnly.solutionWeight());
+  assert(solver.numStatesExplored() == distanceOnly.numStatesExplored());
+  assert(0 == distanceOnly.solutionSize());
+  assert(distanceOnly.solution().empty());
+
+  BiDijkstraSolver<int> same(wdg, 3, 3, 10);
+  assert(std::vector<int>({3}) == same.solution());
+
+  BiDijkstraSolver<int> unsolvable(wdg, 5, 0, 10);
+  assert(0 == unsolvable.outcome());
+  assert(unsolvable.solution().empty());
+
+  /*
+  ////////////////// Testing CompactDirectedGraph. //////////////////
+  */
+  static_assert(IsStaticGraph<CompactDirectedGraph, int>::value,
+                "CompactDirectedGraph must be searchable by the solvers");
+  static_assert(IsStaticGraph<Graph<int>, int>::value,
+                "Graph must be searchable by the solvers");
+  static_assert(!IsStaticGraph<WeightedEdge<int>, int>::value,
+                "WeightedEdge is not a graph");
+
+  CompactDirectedGraph cdg(wdg);
+  assert(7 == cdg.numVertices());
+  assert(12 == cdg.numArcs());
+  assert(3 == cdg.outgoingNeighbors(4).size());
+  assert(2 == cdg.outgoingNeighbors(4).begin()->to);
+  assert(1 == cdg.outgoingNeighbors(4).begin()->weight);
+  assert(0 == cdg.outgoingNeighbors(5).size());
+  assert(3 == cdg.incomingNeighbors(2).size());
+  assert(0 == cdg.incomingNeighbors(2).begin()->to);
+
+  BiDijkstraSolver<int, CompactDirectedGraph> compact(cdg, 0, 6, 10);
+  assert(1 == compact.outcome());
+  assert(solver.solution() == compact.solution());
+  assert(solver.solutionWeight() == compact.solutionWeight());
+  assert(solver.numStatesExplored() == compact.numStatesExplored());
+
+  /*
+  ////////////////// Testing multi-source/multi-target. //////////////////
+  */
+  typedef std::vector<std::pair<int, double>> Seeds;
+  BiDijkstraSolver<int> multi(wdg, Seeds({{0, 0}, {3, 0}}),
+                              Seeds({{5, 0}, {6, 0}}), 10);
+  assert(1 == multi.outcome());
+  assert(std::vector<int>({3, 4, 5}) == multi.solution());
+  assert(6 == multi.solutionWeight());
+  assert(3 == multi.solutionStart());
+  assert(5 == multi.solutionEnd());
+
+  // Offsets count towards the total weight.
+  BiDijkstraSolver<int> offsets(wdg, Seeds({{0, 0}, {3, 10}}),
+                                Seeds({{5, 0}, {6, 0}}), 10);
+  assert(std::vector<int>({0, 1, 4, 5}) == offsets.solution());
+  assert(9 == offsets.solutionWeight());
+
+  BiDijkstraSolver<int> nearest(wdg, Seeds({{0, 0}}),
+                                Seeds({{2, 20}, {3, 0}, {5, 0}, {6, 0}}),
+                                10, 3);
+  assert(std::vector<int>({0, 1, 4, 5}) == nearest.solution());
+  assert(3 == nearest.nearestEnds().size());
+  assert(std::make_pair(5, 9.0) == nearest.nearestEnds()[0]);
+  assert(std::make_pair(6, 10.0) == nearest.nearestEnds()[1]);
+  assert(std::make_pair(3, 11.0) == nearest.nearestEnds()[2]);
+  assert(nearest.nearestEndsComplete());
+
+  // A start that is also an end solves before any time check; the
+  // time-out then cuts the nearest ends short.
+  BiDijkstraSolver<int> cutShort(wdg, Seeds({{0, 0}}),
+                                 Seeds({{0, 0}, {5, 0}, {6, 0}}), 0, 3);
+  assert(1 == cutShort.outcome());
+  assert(0 == cutShort.solutionWeight());
+  assert(!cutShort.nearestEndsComplete());
+  assert(cutShort.nearestEnds().size() < 3);
+  assert(!multi.nearestEndsComplete());  // No 'kNearest' given.
+
+  /*
+  ////////////////// Testing ShortestPathSession. //////////////////
+  */
+  ShortestPathSession<int> session(wdg, 0);
+  assert(1 == session.query(6, 10));
+  assert(std::vector<int>({0, 1, 4, 6}) == session.solution());
+  assert(10 == session.solutionWeight());
+  int settledBefore = session.numForwardSettled();
+
+  // 2 was settled by the forward search already: no search needed.
+  assert(1 == session.query(2, 10));
+  assert(std::vector<int>({0, 2}) == session.solution());
+  assert(1 == session.solutionWeight());
+  assert(0 == session.numStatesExplored());
+  assert(settledBefore == session.numForwardSettled());
+
+  for (int end = 0; end < 7; end++) {
+    BiDijkstraSolver<int> fresh(wdg, 0, end, 10);
+    assert(fresh.outcome() == session.query(end, 10));
+    assert(fresh.solutionWeight() == session.solutionWeight());
+    assert(fresh.solution() == session.solution());
+  }
+
+  ShortestPathSession<int, CompactDirectedGraph> stuck(cdg, 5);
+  assert(0 == stuck.query(0, 10));
+  assert(stuck.solution().empty());
+  assert(1 == stuck.query(5, 10));
+  assert(std::vector<int>({5}) == stuck.solution());
+
+  /*
+  ////////////////// Testing bidirectional A*. //////////////////
+  */
+  Coordinates haversine(std::vector<float>({0, 0}),
+                        std::vector<float>({0, 1}), Coordinates::kHaversine);
+  assert(std::fabs(haversine.distance(0, 1) - 111195) < 1);
+
+  // Grid with unit spacing; every edge weighs between 1 and 2 times its
+  // length, so no edge is faster than 1.
+  const int side = 30;
+  std::vector<WeightedEdge<int>> gridEdges;
+  std::vector<float> xs, ys;
+  for (int v = 0; v < side * side; v++) {
+    xs.push_back(v % side);
+    ys.push_back(v / side);
+    int neighbors[2] = {v % side + 1 < side ? v + 1 : -1,
+                        v / side + 1 < side ? v + side : -1};
+    for (auto& w : neighbors) {
+      if (w == -1)
+        continue;
+      gridEdges.push_back(WeightedEdge<int>(v, w, 1 + (v * 7 + w) % 10 / 10.0));
+      gridEdges.push_back(WeightedEdge<int>(w, v, 1 + (v * 3 + w) % 10 / 10.0));
+    }
+  }
+  CompactDirectedGraph grid(side * side, gridEdges);
+  assert(!grid.setCoordinates(haversine));
+  std::vector<float> shortYs(ys.begin(), ys.end() - 1);
+  assert(0 == Coordinates(xs, shortYs).size());
+  assert(!grid.setCoordinates(Coordinates(xs, shortYs)));
+  assert(grid.setCoordinates(Coordinates(xs, ys)));
+  double speed = grid.coordinates()->maxSpeed(grid);
+  assert(1 == speed);
+
+  int plainStates = 0, aStarStates = 0;
+  for (int q = 0; q < 50; q++) {
+    int s = (q * 37) % (side * side), t = (q * 101 + 7) % (side * side);
+    BiDijkstraSolver<int, CompactDirectedGraph> plain(grid, s, t, 10);
+    BiDijkstraSolver<int, CompactDirectedGraph> aStar(grid, s, t, 10,
+                                                      *grid.coordinates(),
+                                                      speed);
+    assert(1 == aStar.outcome());
+    assert(std::fabs(plain.solutionWeight() - aStar.solutionWeight()) < 1e-9);
+    assert(s == aStar.solution().front() && t == aStar.solution().back());
+    plainStates += plain.numStatesExplored();
+    aStarStates += aStar.numStatesExplored();
+  }
+  assert(aStarStates < plainStates);
+  std::cout << "Grid states explored: " << plainStates << " plain, "
+            << aStarStates << " with A*" << std::endl;
+
+  // Coordinates that all coincide give no speed bound, and coordinates of
+  // another graph do not fit; both fall back to plain Dijkstra's.
+  Coordinates flat(std::vector<float>(side * side, 0),
+                   std::vector<float>(side * side, 0));
+  assert(0 == flat.maxSpeed(grid));
+  BiDijkstraSolver<int, CompactDirectedGraph> plain(grid, 0, side * side - 1,
+                                                    10);
+  BiDijkstraSolver<int, CompactDirectedGraph> zeroSpeed(grid, 0,
+                                                        side * side - 1, 10,
+                                                        flat, 0);
+  BiDijkstraSolver<int, CompactDirectedGraph> misfit(grid, 0, side * side - 1,
+                                                     10, haversine, speed);
+  assert(plain.solutionWeight() == zeroSpeed.solutionWeight());
+  assert(plain.numStatesExplored() == zeroSpeed.numStatesExplored());
+  assert(plain.solutionWeight() == misfit.solutionWeight());
+
+  /*
+  ////////////////// Testing bounded searches. //////////////////
+  */
+  const int corner = side * side - 1;
+  BiDijkstraSolver<int, CompactDirectedGraph> far(grid, 0, corner, 10);
+  double farWeight = far.solutionWeight();
+  assert(farWeight == far.lowerBound() && farWeight == far.bestWeightFound());
+
+  // Within the bounds: same result.
+  BiDijkstraSolver<int, CompactDirectedGraph> within(
+      grid, 0, corner, 10, false, SearchBounds(farWeight + 1));
+  assert(1 == within.outcome());
+  assert(farWeight == within.solutionWeight());
+  assert(std::vector<int>(far.solution()) == within.solution());
+
+  // Too far: no solution, but bounds on its weight.
+  BiDijkstraSolver<int, CompactDirectedGraph> tooFar(
+      grid, 0, corner, 10, false, SearchBounds(farWeight - 1));
+  assert(-2 == tooFar.outcome());
+  assert(std::isinf(tooFar.solutionWeight()) && tooFar.solution().empty());
+  assert(farWeight - 1 <= tooFar.lowerBound());
+  assert(tooFar.lowerBound() <= farWeight);
+  assert(farWeight <= tooFar.bestWeightFound());
+
+  // A small radius gives up on far pairs after exploring little.
+  BiDijkstraSolver<int, CompactDirectedGraph> local(
+      grid, 0, corner, 10, true, SearchBounds(5));
+  assert(-2 == local.outcome());
+  assert(5 <= local.lowerBound());
+  assert(local.numStatesExplored() * 10 < far.numStatesExplored());
+  BiDijkstraSolver<int, CompactDirectedGraph> near(
+      grid, 0, side + 1, 10, true, SearchBounds(5));
+  assert(1 == near.outcome());
+
+  // Both searches can stay within the radius yet meet beyond it.
+  WeightedDirectedGraph twoHops(3);
+  twoHops.addEdge(0, 1, 5);
+  twoHops.addEdge(1, 2, 5);
+  BiDijkstraSolver<int> meetBeyond(twoHops, 0, 2, 10, false,
+                                   SearchBounds(6));
+  assert(-2 == meetBeyond.outcome());
+  assert(meetBeyond.solution().empty());
+  assert(6 == meetBeyond.lowerBound());
+  assert(10 == meetBeyond.bestWeightFound());
+
+  // Work bound: each direction settles at most 'maxSettled' vertices.
+  BiDijkstraSolver<int, CompactDirectedGraph> capped(
+      grid, 0, corner, 10, false, SearchBounds(farWeight + 1, 20));
+  assert(-2 == capped.outcome());
+  assert(40 == capped.numStatesExplored());
+  assert(capped.lowerBound() <= farWeight);
+
+  // Bounds apply to A* as well.
+  BiDijkstraSolver<int, CompactDirectedGraph> aStarTooFar(
+      grid, 0, corner, 10, *grid.coordinates(), speed, false,
+      SearchBounds(farWeight - 1));
+  assert(-2 == aStarTooFar.outcome());
+  BiDijkstraSolver<int, CompactDirectedGraph> aStarWithin(
+      grid, 0, corner, 10, *grid.coordinates(), speed, false,
+      SearchBounds(farWeight + 1));
+  assert(std::fabs(farWeight - aStarWithin.solutionWeight()) < 1e-9);
+
+  // Unsolvable stays unsolvable.
+  BiDijkstraSolver<int> boundedUnsolvable(wdg, 5, 0, 10, false,
+                                          SearchBounds(100, 100));
+  assert(0 == boundedUnsolvable.outcome());
+
+  /*
+  ////////////////// Testing KShortestPathsSolver. //////////////////
+  */
+  KShortestPathsSolver<int> ksp(wdg, 0, 6, 3, 10);
+  assert(1 == ksp.outcome());
+  // Only two simple paths lead from 0 to 6.
+  assert(2 == ksp.numPaths());
+  assert(std::vector<int>({0, 1, 4, 6}) == ksp.path(0));
+  assert(10 == ksp.pathWeight(0));
+  assert(std::vector<int>({0, 1, 3, 4, 6}) == ksp.path(1));
+  assert(20 == ksp.pathWeight(1));
+
+  KShortestPathsSolver<int, CompactDirectedGraph> kspCompact(cdg, 0, 6, 3, 10);
+  assert(2 == kspCompact.numPaths());
+  assert(ksp.path(1) == kspCompact.path(1));
+
+  // The backward search stops short of the far side of the grid.
+  BiDijkstraSolver<int, CompactDirectedGraph> nearby(grid, 0, side + 1, 10);
+  KShortestPathsSolver<int, CompactDirectedGraph> kspNear(grid, 0, side + 1,
+                                                          5, 10);
+  assert(5 == kspNear.numPaths());
+  assert(std::fabs(nearby.solutionWeight() - kspNear.pathWeight(0)) < 1e-9);
+  for (int i = 1; i < 5; i++) {
+    assert(kspNear.pathWeight(i - 1) <= kspNear.pathWeight(i));
+    assert(kspNear.path(i - 1) != kspNear.path(i));
+  }
+  assert(kspNear.numStatesExplored() < side * side);
+
+  KShortestPathsSolver<int> kspUnsolvable(wdg, 5, 0, 3, 10);
+  assert(0 == kspUnsolvable.outcome());
+  assert(0 == kspUnsolvable.numPaths());
+
+  /*
+  ////////////////// Testing AlternativeRouteSolver. //////////////////
+  */
+  WeightedDirectedGraph alt(7);
+  alt.addEdge(0, 1, 1);  // Shortest route: 0=>1=>2=>5.
+  alt.addEdge(1, 2, 1);
+  alt.addEdge(2, 5, 1);
+  alt.addEdge(0, 3, 1);  // Good alternative: 0=>3=>4=>5.
+  alt.addEdge(3, 4, 1.2);
+  alt.addEdge(4, 5, 1);
+  alt.addEdge(0, 6, 2);  // Too long: 0=>6=>5.
+  alt.addEdge(6, 5, 2);
+
+  AlternativeRouteSolver<int> ars(alt, 0, 5, 2, 10);
+  assert(1 == ars.outcome());
+  assert(2 == ars.numRoutes());
+  assert(std::vector<int>({0, 1, 2, 5}) == ars.route(0));
+  assert(3 == ars.routeWeight(0));
+  assert(std::vector<int>({0, 3, 4, 5}) == ars.route(1));
+  assert(3.2 == ars.routeWeight(1));
+
+  // The long detour fails the local optimality check even with more
+  // stretch allowed, unless that check is disabled.
+  AlternativeRouteSolver<int> arsStretch(alt, 0, 5, 2, 10, 0.5);
+  assert(2 == arsStretch.numRoutes());
+  AlternativeRouteSolver<int> arsLoose(alt, 0, 5, 2, 10, 0.5, 0.8, 0);
+  assert(3 == arsLoose.numRoutes());
+  assert(std::vector<int>({0, 6, 5}) == arsLoose.route(2));
+
+  // From a vertex to itself, the empty route is the only one.
+  AlternativeRouteSolver<int> arsSame(alt, 0, 0, 2, 10);
+  assert(1 == arsSame.outcome());
+  assert(1 == arsSame.numRoutes());
+  assert(std::vector<int>({0}) == arsSame.route(0));
+
+  AlternativeRouteSolver<int> arsUnsolvable(alt, 5, 0, 2, 10);
+  assert(0 == arsUnsolvable.outcome());
+  assert(0 == arsUnsolvable.numRoutes());
 }
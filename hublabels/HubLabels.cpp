@@ -0,0 +1,411 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>  // For numeric_limits
+#include <utility>  // For pair
+#include "HubLabels.h"
+#include "../pq/ExtrinsicMinPQ.h"
+
+/*
+ * Hub rank terminating every label. Larger than any real rank, so a
+ * merge of two labels needs no bounds checks.
+*/
+static const uint32_t kSentinelHub = std::numeric_limits<uint32_t>::max();
+
+/*
+ * Layout of an index file: this header, followed by the forward and
+ * backward offsets, the forward and backward distances, and finally the
+ * forward and backward hub ranks. Every section starts 8-byte aligned.
+*/
+typedef struct {
+  char magic[8];
+  uint64_t V;
+  uint64_t forwardEntries;
+  uint64_t backwardEntries;
+} HubLabelsHeader;
+
+static const char kMagic[8] = {'H', 'U', 'B', 'L', 'B', 'L', 'S', '1'};
+
+typedef std::vector<std::pair<uint32_t, double>> Label;
+
+/*
+ * Helper function running one pruned Dijkstra's from 'root' (of the given
+ * 'rank'), forwards over outgoing edges or backwards over incoming ones.
+ *
+ * Forwards, 'rootLabel' is the root's forward label and 'labels' are the
+ * backward labels; a vertex u reached at distance d gets (rank, d) added
+ * to its label unless an existing common hub already covers root => u
+ * at distance d or less, in which case the search is pruned at u.
+ * Backwards, the roles of the two label sets are swapped.
+ *
+ * 'dist' and 'rootDists' are scratch arrays of size V, all infinity on
+ * entry and on exit.
+*/
+template <typename GraphType>
+static void prunedSearch(const GraphType& graph, const int root,
+                         const uint32_t rank, const bool forward,
+                         const Label& rootLabel, std::vector<Label>* labels,
+                         std::vector<double>* dist,
+                         std::vector<double>* rootDists) {
+  const double infinity = std::numeric_limits<double>::infinity();
+  for (auto& entry : rootLabel)
+    (*rootDists)[entry.first] = entry.second;
+
+  std::vector<int> touched;
+  ExtrinsicMinPQ<int> fringe;
+  fringe.add(root, 0.0);
+  (*dist)[root] = 0.0;
+  touched.push_back(root);
+
+  while (!fringe.isEmpty()) {
+    int* ptr = fringe.removeSmallest();
+    int u = *ptr;
+    delete ptr;
+    double d = (*dist)[u];
+
+    // Prune if a hub of higher rank already covers this pair.
+    bool covered = false;
+    for (auto& entry : (*labels)[u]) {
+      if ((*rootDists)[entry.first] + entry.second <= d) {
+        covered = true;
+        break;
+      }
+    }
+    if (covered)
+      continue;
+    (*labels)[u].push_back(std::make_pair(rank, d));
+
+    auto&& edges = forward ? graph.outgoingNeighbors(u)
+                           : graph.incomingNeighbors(u);
+    for (auto& edge : edges) {
+      int b = edgeTarget(edge);
+      double next = d + edgeWeight(edge);
+      if ((*dist)[b] == infinity) {
+        fringe.add(b, next);
+        (*dist)[b] = next;
+        touched.push_back(b);
+      } else if (next < (*dist)[b]) {
+        fringe.changePriority(b, next);
+        (*dist)[b] = next;
+      }
+    }
+  }
+
+  for (auto& v : touched)
+    (*dist)[v] = infinity;
+  for (auto& entry : rootLabel)
+    (*rootDists)[entry.first] = infinity;
+}
+
+/*
+ * Helper function flattening per-vertex labels into the offsets/hubs/
+ * distances arrays, appending a sentinel to every label.
+*/
+static void flatten(const std::vector<Label>& labels,
+                    std::vector<uint64_t>* offsets,
+                    std::vector<uint32_t>* hubs,
+                    std::vector<double>* dists) {
+  offsets->clear();
+  hubs->clear();
+  dists->clear();
+  for (auto& label : labels) {
+    offsets->push_back(hubs->size());
+    for (auto& entry : label) {
+      hubs->push_back(entry.first);
+      dists->push_back(entry.second);
+    }
+    hubs->push_back(kSentinelHub);
+    dists->push_back(std::numeric_limits<double>::infinity());
+  }
+  offsets->push_back(hubs->size());
+}
+
+/*
+ * Helper function rounding 'bytes' up to a multiple of 8.
+*/
+static size_t alignTo8(const size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+inline HubLabels::HubLabels() : mapping(nullptr), mappingSize(0) {
+  clear();
+}
+
+inline HubLabels::~HubLabels() { clear(); }
+
+template <typename GraphType>
+void HubLabels::build(const GraphType& graph, const int V,
+                      const std::vector<int>& order) {
+  clear();
+
+  // Default order: by decreasing degree.
+  std::vector<int> byRank = order;
+  if (byRank.empty()) {
+    std::vector<std::pair<int, int>> degrees;
+    for (int v = 0; v < V; v++) {
+      int degree = 0;
+      for (auto& edge : graph.outgoingNeighbors(v)) {
+        (void) edge;
+        degree++;
+      }
+      for (auto& edge : graph.incomingNeighbors(v)) {
+        (void) edge;
+        degree++;
+      }
+      degrees.push_back(std::make_pair(-degree, v));
+    }
+    std::sort(degrees.begin(), degrees.end());
+    for (auto& d : degrees)
+      byRank.push_back(d.second);
+  }
+
+  std::vector<Label> forward(V), backward(V);
+  std::vector<double> dist(V, std::numeric_limits<double>::infinity());
+  std::vector<double> rootDists(V, std::numeric_limits<double>::infinity());
+  for (int rank = 0; rank < V; rank++) {
+    int root = byRank[rank];
+    // Searching forwards from the root adds it to backward labels,
+    // and searching backwards adds it to forward labels.
+    prunedSearch(graph, root, rank, true, forward[root], &backward,
+                 &dist, &rootDists);
+    prunedSearch(graph, root, rank, false, backward[root], &forward,
+                 &dist, &rootDists);
+  }
+
+  V_ = V;
+  flatten(forward, &ownedForwardOffsets, &ownedForwardHubs,
+          &ownedForwardDists);
+  flatten(backward, &ownedBackwardOffsets, &ownedBackwardHubs,
+          &ownedBackwardDists);
+  useOwnedStorage();
+}
+
+inline bool HubLabels::save(const std::string& path) const {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr)
+    return false;
+
+  HubLabelsHeader header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.V = V_;
+  header.forwardEntries = forwardOffsets[V_];
+  header.backwardEntries = backwardOffsets[V_];
+
+  const char padding[8] = {0};
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  ok = ok && fwrite(forwardOffsets, sizeof(uint64_t), V_ + 1, file) ==
+                 static_cast<size_t>(V_ + 1);
+  ok = ok && fwrite(backwardOffsets, sizeof(uint64_t), V_ + 1, file) ==
+                 static_cast<size_t>(V_ + 1);
+  ok = ok && fwrite(forwardDists, sizeof(double), header.forwardEntries,
+                    file) == header.forwardEntries;
+  ok = ok && fwrite(backwardDists, sizeof(double), header.backwardEntries,
+                    file) == header.backwardEntries;
+  size_t forwardHubBytes = header.forwardEntries * sizeof(uint32_t);
+  ok = ok && fwrite(forwardHubs, sizeof(uint32_t), header.forwardEntries,
+                    file) == header.forwardEntries;
+  ok = ok && fwrite(padding, 1, alignTo8(forwardHubBytes) - forwardHubBytes,
+                    file) == alignTo8(forwardHubBytes) - forwardHubBytes;
+  ok = ok && fwrite(backwardHubs, sizeof(uint32_t), header.backwardEntries,
+                    file) == header.backwardEntries;
+  return (fclose(file) == 0) && ok;
+}
+
+/*
+ * Helper function checking one direction's labels as loaded from a file:
+ * the offsets start at 0, never decrease and end at 'entries', and every
+ * label consists of hubs less than 'V' followed by the sentinel.
+*/
+static inline bool validLabels(const uint64_t* offsets, const uint32_t* hubs,
+                               const uint64_t V, const uint64_t entries) {
+  if (offsets[0] != 0 || offsets[V] != entries)
+    return false;
+  for (uint64_t v = 0; v < V; v++) {
+    if (offsets[v + 1] <= offsets[v])  // Not even room for the sentinel.
+      return false;
+    for (uint64_t i = offsets[v]; i + 1 < offsets[v + 1]; i++) {
+      if (hubs[i] >= V)
+        return false;
+    }
+    if (hubs[offsets[v + 1] - 1] != kSentinelHub)
+      return false;
+  }
+  return true;
+}
+
+inline bool HubLabels::load(const std::string& path) {
+  clear();
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  if (fstat(fd, &info) < 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(HubLabelsHeader)) {
+    close(fd);
+    return false;
+  }
+  void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);  // The mapping stays valid.
+  if (data == MAP_FAILED)
+    return false;
+  mapping = data;
+  mappingSize = info.st_size;
+
+  // Validate the header and that the sections fit the file exactly, then
+  // the labels themselves, so that no query reads out of bounds.
+  const HubLabelsHeader* header = static_cast<HubLabelsHeader*>(data);
+  if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+    clear();
+    return false;
+  }
+  // Bounding every count by the file's size first keeps the products
+  // below from overflowing.
+  size_t maxCount = mappingSize / sizeof(uint32_t);
+  if (header->V >= static_cast<uint64_t>(std::numeric_limits<int>::max()) ||
+      header->forwardEntries > maxCount ||
+      header->backwardEntries > maxCount) {
+    clear();
+    return false;
+  }
+  const char* base = static_cast<const char*>(data);
+  size_t offset = sizeof(HubLabelsHeader);
+  size_t offsetBytes = (header->V + 1) * sizeof(uint64_t);
+  size_t expected = offset + 2 * offsetBytes +
+                    (header->forwardEntries + header->backwardEntries) *
+                        sizeof(double) +
+                    alignTo8(header->forwardEntries * sizeof(uint32_t)) +
+                    header->backwardEntries * sizeof(uint32_t);
+  if (expected != mappingSize) {
+    clear();
+    return false;
+  }
+
+  V_ = header->V;
+  forwardOffsets = reinterpret_cast<const uint64_t*>(base + offset);
+  offset += offsetBytes;
+  backwardOffsets = reinterpret_cast<const uint64_t*>(base + offset);
+  offset += offsetBytes;
+  forwardDists = reinterpret_cast<const double*>(base + offset);
+  offset += header->forwardEntries * sizeof(double);
+  backwardDists = reinterpret_cast<const double*>(base + offset);
+  offset += header->backwardEntries * sizeof(double);
+  forwardHubs = reinterpret_cast<const uint32_t*>(base + offset);
+  offset += alignTo8(header->forwardEntries * sizeof(uint32_t));
+  backwardHubs = reinterpret_cast<const uint32_t*>(base + offset);
+
+  if (!validLabels(forwardOffsets, forwardHubs, V_,
+                   header->forwardEntries) ||
+      !validLabels(backwardOffsets, backwardHubs, V_,
+                   header->backwardEntries)) {
+    clear();
+    return false;
+  }
+  return true;
+}
+
+inline double HubLabels::distance(const int s, const int t) const {
+  const uint32_t* sHub = forwardHubs + forwardOffsets[s];
+  const double* sDist = forwardDists + forwardOffsets[s];
+  const uint32_t* tHub = backwardHubs + backwardOffsets[t];
+  const double* tDist = backwardDists + backwardOffsets[t];
+
+  // Merge the two sorted labels; both end with the same sentinel.
+  double best = std::numeric_limits<double>::infinity();
+  while (true) {
+    if (*sHub == *tHub) {
+      if (*sHub == kSentinelHub)
+        break;
+      best = std::min(best, *sDist + *tDist);
+      sHub++;
+      sDist++;
+      tHub++;
+      tDist++;
+    } else if (*sHub < *tHub) {
+      sHub++;
+      sDist++;
+    } else {
+      tHub++;
+      tDist++;
+    }
+  }
+  return best;
+}
+
+template <typename GraphType>
+bool HubLabels::path(const GraphType& graph, const int s, const int t,
+                     std::vector<int>* result) const {
+  result->clear();
+  double remaining = distance(s, t);
+  if (remaining == std::numeric_limits<double>::infinity())
+    return false;
+
+  int v = s;
+  result->push_back(v);
+  // A shortest path has at most V vertices; the bound guards against
+  // walking around zero-weight cycles forever.
+  while (v != t && static_cast<int>(result->size()) <= V_) {
+    double tolerance = 1e-9 * std::max(1.0, remaining);
+    bool advanced = false;
+    for (auto& edge : graph.outgoingNeighbors(v)) {
+      int next = edgeTarget(edge);
+      double rest = distance(next, t);
+      if (std::fabs(edgeWeight(edge) + rest - remaining) <= tolerance) {
+        v = next;
+        remaining = rest;
+        result->push_back(v);
+        advanced = true;
+        break;
+      }
+    }
+    if (!advanced)
+      break;
+  }
+  if (v != t) {
+    result->clear();
+    return false;
+  }
+  return true;
+}
+
+inline double HubLabels::averageLabelSize() const {
+  if (V_ == 0)
+    return 0.0;
+  // Do not count the sentinels.
+  return static_cast<double>(forwardOffsets[V_] + backwardOffsets[V_] -
+                             2 * V_) / (2 * V_);
+}
+
+inline void HubLabels::clear() {
+  if (mapping != nullptr)
+    munmap(mapping, mappingSize);
+  mapping = nullptr;
+  mappingSize = 0;
+
+  ownedForwardOffsets.assign(1, 0);
+  ownedBackwardOffsets.assign(1, 0);
+  ownedForwardHubs.clear();
+  ownedBackwardHubs.clear();
+  ownedForwardDists.clear();
+  ownedBackwardDists.clear();
+  V_ = 0;
+  useOwnedStorage();
+}
+
+inline void HubLabels::useOwnedStorage() {
+  forwardOffsets = ownedForwardOffsets.data();
+  backwardOffsets = ownedBackwardOffsets.data();
+  forwardHubs = ownedForwardHubs.data();
+  backwardHubs = ownedBackwardHubs.data();
+  forwardDists = ownedForwardDists.data();
+  backwardDists = ownedBackwardDists.data();
+}
@@ -0,0 +1,138 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef HUBLABELS_H_
+#define HUBLABELS_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "../graph/StaticGraph.h"
+
+/*
+ * Hub labeling index for exact shortest-path distance queries on a fixed
+ * graph whose vertices are of primitive type 'int', from 0 to V - 1.
+ *
+ * Every vertex v gets a forward label (hubs h with the distance v => h)
+ * and a backward label (hubs h with the distance h => v), chosen so that
+ * some shortest path from s to t always passes through a hub common to
+ * the forward label of s and the backward label of t. A distance query
+ * is then a single merge of two sorted arrays, with no graph search.
+ *
+ * Labels are built offline by pruned labeling: one pruned Dijkstra's in
+ * each direction from every vertex, most important vertices first. Hubs
+ * are identified by their rank in that order, so labels come out sorted.
+ *
+ * All labels are stored in flat arrays (offsets, hub ranks, distances),
+ * each vertex's label terminated by a sentinel hub. Indexes can be saved
+ * to disk and loaded back with mmap, without any parsing or copying.
+*/
+class HubLabels {
+ public:
+  /*
+   * Ctor & Dtor.
+   * The index is empty until built or loaded.
+  */
+  HubLabels();
+  ~HubLabels();
+
+  /*
+   * Not copyable; a loaded index owns its memory mapping.
+  */
+  HubLabels(const HubLabels&) = delete;
+  HubLabels& operator=(const HubLabels&) = delete;
+
+  /*
+   * Builds the labels of 'graph', which has 'V' vertices. 'order' lists
+   * the vertices from most to least important; if empty, vertices are
+   * ordered by decreasing degree. Any previous index is discarded.
+   *
+   * Read "graph/StaticGraph.h" for the requirements on 'GraphType'.
+  */
+  template <typename GraphType>
+  void build(const GraphType& graph, const int V,
+             const std::vector<int>& order = std::vector<int>());
+
+  /*
+   * Writes the index to the file at 'path'.
+   * Returns true on success, false otherwise.
+  */
+  bool save(const std::string& path) const;
+
+  /*
+   * Maps the index in the file at 'path' into memory, read-only.
+   * Any previous index is discarded. Returns true on success, false if
+   * the file cannot be mapped or is not a valid index.
+  */
+  bool load(const std::string& path);
+
+  /*
+   * Returns the shortest-path distance from 's' to 't'.
+   * Returns std::numeric_limits<double>::infinity() if 't' is not
+   * reachable from 's'.
+  */
+  double distance(const int s, const int t) const;
+
+  /*
+   * Recovers a shortest path from 's' to 't' by walking 'graph' (the
+   * graph the index was built for) along edges that keep the remaining
+   * distance exact. Returns false if 't' is not reachable from 's'.
+  */
+  template <typename GraphType>
+  bool path(const GraphType& graph, const int s, const int t,
+            std::vector<int>* result) const;
+
+  /*
+   * Returns the number of vertices covered by the index.
+  */
+  int numVertices() const { return V_; }
+
+  /*
+   * Returns the average number of hubs per label (both directions).
+  */
+  double averageLabelSize() const;
+
+ private:
+  /*
+   * Storage used when the index was built in memory.
+  */
+  std::vector<uint64_t> ownedForwardOffsets, ownedBackwardOffsets;
+  std::vector<uint32_t> ownedForwardHubs, ownedBackwardHubs;
+  std::vector<double> ownedForwardDists, ownedBackwardDists;
+
+  /*
+   * Storage used when the index was loaded from disk.
+  */
+  void* mapping;
+  size_t mappingSize;
+
+  /*
+   * Views of the index, into whichever storage is in use.
+   * Vertex v's forward label spans entries forwardOffsets[v] up to
+   * forwardOffsets[v + 1] - 1, the last of which is the sentinel.
+  */
+  int V_;
+  const uint64_t* forwardOffsets;
+  const uint64_t* backwardOffsets;
+  const uint32_t* forwardHubs;
+  const uint32_t* backwardHubs;
+  const double* forwardDists;
+  const double* backwardDists;
+
+  /*
+   * Drops the current index, unmapping it if it was loaded.
+  */
+  void clear();
+
+  /*
+   * Points the views at the owned (built) storage.
+  */
+  void useOwnedStorage();
+};
+
+#include "HubLabels.cpp"
+
+#endif  // HUBLABELS_H_
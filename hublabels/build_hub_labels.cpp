@@ -0,0 +1,50 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+/*
+ * Offline builder for hub labeling indexes.
+ *
+ * Usage:
+ *   build_hub_labels GRAPH_FILE INDEX_FILE
+ *
+ * GRAPH_FILE is an edge list as read by "server/GraphLoader.h".
+*/
+
+#include <chrono>
+#include <iostream>
+#include "HubLabels.h"
+#include "../graph/CompactDirectedGraph.h"
+#include "../server/GraphLoader.h"
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " GRAPH_FILE INDEX_FILE" << std::endl;
+    return 1;
+  }
+
+  unique_ptr<WeightedDirectedGraph> loaded = loadGraph(argv[1]);
+  if (!loaded) {
+    std::cerr << "Could not load graph from " << argv[1] << std::endl;
+    return 1;
+  }
+  CompactDirectedGraph graph(*loaded);
+  loaded.reset();
+
+  auto start = std::chrono::steady_clock::now();
+  HubLabels labels;
+  labels.build(graph, graph.numVertices());
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << "Built labels for " << labels.numVertices() << " vertices in "
+            << elapsed.count() << " seconds; average label size "
+            << labels.averageLabelSize() << std::endl;
+
+  if (!labels.save(argv[2])) {
+    std::cerr << "Could not write " << argv[2] << std::endl;
+    return 1;
+  }
+  return 0;
+}
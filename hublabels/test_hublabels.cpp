@@ -0,0 +1,116 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "HubLabels.h"
+#include "../graph/CompactDirectedGraph.h"
+#include "../server/GraphLoader.h"
+#include "../solver/BiDijkstraSolver.h"
+
+int main(int argc, char* argv[]) {
+  /*
+  ////////////////// Small graph. //////////////////
+  */
+  WeightedDirectedGraph wdg(7);
+  wdg.addEdge(0, 1, 2);
+  wdg.addEdge(0, 2, 1);
+  wdg.addEdge(1, 2, 5);
+  wdg.addEdge(1, 3, 11);
+  wdg.addEdge(1, 4, 3);
+  wdg.addEdge(2, 5, 15);
+  wdg.addEdge(3, 4, 2);
+  wdg.addEdge(4, 2, 1);
+  wdg.addEdge(4, 5, 4);
+  wdg.addEdge(4, 6, 5);
+  wdg.addEdge(6, 3, 1);
+  wdg.addEdge(6, 5, 1);
+
+  HubLabels small;
+  assert(0 == small.numVertices());
+  small.build(wdg, 7);
+  assert(7 == small.numVertices());
+  assert(10 == small.distance(0, 6));
+  assert(0 == small.distance(3, 3));
+  assert(11 == small.distance(0, 3));
+  assert(std::numeric_limits<double>::infinity() == small.distance(5, 0));
+
+  std::vector<int> path;
+  assert(small.path(wdg, 0, 6, &path));
+  assert(std::vector<int>({0, 1, 4, 6}) == path);
+  assert(!small.path(wdg, 5, 0, &path));
+  assert(path.empty());
+
+  /*
+  ////////////////// Random graph vs. BiDijkstraSolver. //////////////////
+  */
+  const int V = 500;
+  unique_ptr<WeightedDirectedGraph> random = randomGraph(V, 1500, 17);
+  CompactDirectedGraph graph(*random);
+  HubLabels labels;
+  labels.build(graph, V);
+  std::cout << "Average label size: " << labels.averageLabelSize()
+            << std::endl;
+
+  for (int s = 0; s < V; s += 37) {
+    for (int t = 0; t < V; t += 41) {
+      BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, s, t, 10);
+      assert(std::fabs(solver.solutionWeight() - labels.distance(s, t)) <
+             1e-9);
+      assert(labels.path(graph, s, t, &path));
+      assert(s == path.front() && t == path.back());
+    }
+  }
+
+  /*
+  ////////////////// Saving and loading. //////////////////
+  */
+  const char* file = "test_hublabels.bin";
+  assert(labels.save(file));
+  HubLabels loaded;
+  assert(loaded.load(file));
+  assert(V == loaded.numVertices());
+  assert(labels.averageLabelSize() == loaded.averageLabelSize());
+  for (int s = 0; s < V; s += 13) {
+    for (int t = 0; t < V; t += 7)
+      assert(labels.distance(s, t) == loaded.distance(s, t));
+  }
+
+  // So does loading an index whose labels were corrupted: an offset
+  // array not starting at 0, a header claiming an absurd size, or the
+  // last label missing its sentinel.
+  const long kFirstOffset = 32, kHeaderV = 8;
+  const uint64_t corruptions[][2] = {
+    {kFirstOffset, 1}, {kHeaderV, (1ULL << 61) - 1}};
+  for (auto& corruption : corruptions) {
+    assert(labels.save(file));
+    FILE* index = fopen(file, "r+b");
+    fseek(index, corruption[0], SEEK_SET);
+    fwrite(&corruption[1], sizeof(uint64_t), 1, index);
+    fclose(index);
+    assert(!loaded.load(file));
+  }
+  assert(labels.save(file));
+  FILE* index = fopen(file, "r+b");
+  fseek(index, -4, SEEK_END);
+  const uint32_t hub = 0;
+  fwrite(&hub, sizeof(hub), 1, index);
+  fclose(index);
+  assert(!loaded.load(file));
+
+  // Loading something that is not an index fails cleanly.
+  FILE* bogus = fopen(file, "wb");
+  fputs("not an index", bogus);
+  fclose(bogus);
+  assert(!loaded.load(file));
+  assert(0 == loaded.numVertices());
+  assert(!loaded.load("does_not_exist.bin"));
+  remove(file);
+}
@@ -0,0 +1,360 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "ComponentIndex.h"
+
+/*
+ * Subproblems with fewer vertices than this are solved by Tarjan's
+ * algorithm instead of being split further.
+*/
+static const size_t kTarjanThreshold = 4096;
+
+template <typename GraphType>
+ComponentIndex::ComponentIndex(const GraphType& graph, const int V,
+                               const int numThreads) {
+  findComponents(graph, V, numThreads);
+
+  // Edges of the condensation, without duplicates.
+  std::vector<std::vector<int>> edges(numComponents_);
+  for (int u = 0; u < V; u++) {
+    for (auto& edge : graph.outgoingNeighbors(u)) {
+      int d = components_[edgeTarget(edge)];
+      if (d != components_[u])
+        edges[components_[u]].push_back(d);
+    }
+  }
+  std::vector<int> inDegree(numComponents_, 0);
+  for (auto& children : edges) {
+    std::sort(children.begin(), children.end());
+    children.erase(std::unique(children.begin(), children.end()),
+                   children.end());
+    for (auto& d : children)
+      inDegree[d]++;
+  }
+
+  // Renumber the components in topological order (Kahn's algorithm).
+  std::vector<int> rank(numComponents_);
+  std::vector<int> queue;
+  for (int c = 0; c < numComponents_; c++) {
+    if (inDegree[c] == 0)
+      queue.push_back(c);
+  }
+  for (size_t next = 0; next < queue.size(); next++) {
+    int c = queue[next];
+    rank[c] = next;
+    for (auto& d : edges[c]) {
+      if (--inDegree[d] == 0)
+        queue.push_back(d);
+    }
+  }
+  for (auto& c : components_)
+    c = rank[c];
+
+  std::vector<std::vector<int>> dag(numComponents_);
+  for (int c = 0; c < numComponents_; c++) {
+    for (auto& d : edges[c])
+      dag[rank[c]].push_back(rank[d]);
+  }
+  labelCondensation(dag);
+}
+
+template <typename GraphType>
+void ComponentIndex::findComponents(const GraphType& graph, const int V,
+                                    const int numThreads) {
+  typedef decltype(std::begin(std::declval<const GraphType&>()
+                   .outgoingNeighbors(std::declval<const int&>()))) ArcIter;
+
+  components_.assign(V, -1);
+  std::atomic<int> nextComponent(0);
+
+  // Trim: a vertex without incoming or outgoing edges (left) is a
+  // component of its own.
+  std::vector<int> inDegree(V, 0), outDegree(V, 0);
+  for (int u = 0; u < V; u++) {
+    for (auto& edge : graph.outgoingNeighbors(u)) {
+      outDegree[u]++;
+      inDegree[edgeTarget(edge)]++;
+    }
+  }
+  std::vector<int> trimmed;
+  for (int v = 0; v < V; v++) {
+    if (inDegree[v] == 0 || outDegree[v] == 0) {
+      components_[v] = nextComponent++;
+      trimmed.push_back(v);
+    }
+  }
+  for (size_t next = 0; next < trimmed.size(); next++) {
+    int v = trimmed[next];
+    for (auto& edge : graph.outgoingNeighbors(v)) {
+      int w = edgeTarget(edge);
+      if (components_[w] == -1 && --inDegree[w] == 0) {
+        components_[w] = nextComponent++;
+        trimmed.push_back(w);
+      }
+    }
+    for (auto& edge : graph.incomingNeighbors(v)) {
+      int w = edgeTarget(edge);
+      if (components_[w] == -1 && --outDegree[w] == 0) {
+        components_[w] = nextComponent++;
+        trimmed.push_back(w);
+      }
+    }
+  }
+
+  /*
+   * Every subproblem has a color of its own, shared by its vertices;
+   * vertices whose component is known have color -1. Subproblems are
+   * disjoint, so each can be worked on by one thread without locking.
+  */
+  struct Task {
+    int color;
+    std::vector<int> vertices;
+  };
+  std::vector<std::atomic<int>> colors(V);
+  Task all;
+  all.color = 0;
+  for (int v = 0; v < V; v++) {
+    colors[v].store(components_[v] == -1 ? 0 : -1);
+    if (components_[v] == -1)
+      all.vertices.push_back(v);
+  }
+  std::atomic<int> nextColor(1);
+
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::deque<Task> tasks;
+  int pending = 0;  // Tasks queued or being worked on.
+  if (!all.vertices.empty()) {
+    tasks.push_back(std::move(all));
+    pending = 1;
+  }
+
+  // Tarjan's algorithm, over the vertices of the given color only.
+  auto tarjan = [&](const Task& task, std::vector<int>* index,
+                    std::vector<int>* low) {
+    struct Frame {
+      int v;
+      ArcIter next;
+      ArcIter end;
+    };
+    std::vector<Frame> frames;
+    std::vector<int> stack;
+    int counter = 0;
+    for (auto& root : task.vertices) {
+      if ((*index)[root] != -1)
+        continue;
+      (*index)[root] = (*low)[root] = counter++;
+      stack.push_back(root);
+      auto&& edges = graph.outgoingNeighbors(root);
+      frames.push_back(Frame{root, std::begin(edges), std::end(edges)});
+
+      while (!frames.empty()) {
+        Frame& frame = frames.back();
+        int v = frame.v;
+        if (frame.next != frame.end) {
+          int w = edgeTarget(*frame.next);
+          ++frame.next;
+          if (colors[w].load(std::memory_order_relaxed) != task.color)
+            continue;
+          if ((*index)[w] == -1) {
+            (*index)[w] = (*low)[w] = counter++;
+            stack.push_back(w);
+            auto&& next = graph.outgoingNeighbors(w);
+            frames.push_back(Frame{w, std::begin(next), std::end(next)});
+          } else if (components_[w] == -1) {  // Still on the stack.
+            (*low)[v] = std::min((*low)[v], (*index)[w]);
+          }
+          continue;
+        }
+
+        frames.pop_back();
+        if (!frames.empty())
+          (*low)[frames.back().v] = std::min((*low)[frames.back().v],
+                                             (*low)[v]);
+        if ((*low)[v] == (*index)[v]) {
+          int id = nextComponent++;
+          int w;
+          do {
+            w = stack.back();
+            stack.pop_back();
+            components_[w] = id;
+          } while (w != v);
+        }
+      }
+    }
+    for (auto& v : task.vertices) {
+      colors[v].store(-1, std::memory_order_relaxed);
+      (*index)[v] = -1;
+    }
+  };
+
+  // One forward-backward step: the component of a pivot, plus up to
+  // three subproblems for the rest.
+  auto split = [&](const Task& task, std::vector<Task>* subtasks) {
+    const int c = task.color;
+    const int forwardColor = nextColor++;
+    const int backwardColor = nextColor++;
+    int pivot = task.vertices[0];
+
+    std::vector<int> queue(1, pivot);
+    colors[pivot].store(forwardColor, std::memory_order_relaxed);
+    for (size_t next = 0; next < queue.size(); next++) {
+      for (auto& edge : graph.outgoingNeighbors(queue[next])) {
+        int w = edgeTarget(edge);
+        if (colors[w].load(std::memory_order_relaxed) == c) {
+          colors[w].store(forwardColor, std::memory_order_relaxed);
+          queue.push_back(w);
+        }
+      }
+    }
+
+    int id = nextComponent++;
+    queue.assign(1, pivot);
+    colors[pivot].store(-1, std::memory_order_relaxed);
+    components_[pivot] = id;
+    for (size_t next = 0; next < queue.size(); next++) {
+      for (auto& edge : graph.incomingNeighbors(queue[next])) {
+        int w = edgeTarget(edge);
+        int color = colors[w].load(std::memory_order_relaxed);
+        if (color == forwardColor) {
+          colors[w].store(-1, std::memory_order_relaxed);
+          components_[w] = id;
+          queue.push_back(w);
+        } else if (color == c) {
+          colors[w].store(backwardColor, std::memory_order_relaxed);
+          queue.push_back(w);
+        }
+      }
+    }
+
+    subtasks->assign(3, Task());
+    (*subtasks)[0].color = forwardColor;
+    (*subtasks)[1].color = backwardColor;
+    (*subtasks)[2].color = c;
+    for (auto& v : task.vertices) {
+      int color = colors[v].load(std::memory_order_relaxed);
+      for (auto& subtask : *subtasks) {
+        if (subtask.color == color)
+          subtask.vertices.push_back(v);
+      }
+    }
+  };
+
+  auto work = [&]() {
+    std::vector<int> index(V, -1), low(V);
+    std::vector<Task> subtasks;
+    while (true) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&] { return !tasks.empty() || pending == 0; });
+        if (tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+
+      subtasks.clear();
+      if (task.vertices.size() < kTarjanThreshold)
+        tarjan(task, &index, &low);
+      else
+        split(task, &subtasks);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& subtask : subtasks) {
+          if (!subtask.vertices.empty()) {
+            tasks.push_back(std::move(subtask));
+            pending++;
+          }
+        }
+        pending--;
+      }
+      ready.notify_all();
+    }
+  };
+
+  int threads = numThreads > 0 ? numThreads
+                               : std::thread::hardware_concurrency();
+  threads = std::max(1, threads);
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; t++)
+    pool.push_back(std::thread(work));
+  work();
+  for (auto& thread : pool)
+    thread.join();
+
+  numComponents_ = nextComponent;
+}
+
+inline void ComponentIndex::labelCondensation(
+                const std::vector<std::vector<int>>& dag) {
+  lows.assign(numComponents_ * kNumIntervals, 0);
+  posts.assign(numComponents_ * kNumIntervals, 0);
+
+  // Traversal i visits components and their children in increasing
+  // order if i is even, decreasing otherwise, for different labels.
+  std::vector<bool> visited;
+  std::vector<std::pair<int, size_t>> frames;  // Component, next child.
+  for (int i = 0; i < kNumIntervals; i++) {
+    const bool reversed = i % 2 == 1;
+    visited.assign(numComponents_, false);
+    int post = 0;
+    for (int r = 0; r < numComponents_; r++) {
+      int root = reversed ? numComponents_ - 1 - r : r;
+      if (visited[root])
+        continue;
+      visited[root] = true;
+      frames.push_back(std::make_pair(root, 0));
+
+      while (!frames.empty()) {
+        int c = frames.back().first;
+        const std::vector<int>& children = dag[c];
+        size_t next = frames.back().second;
+        if (next < children.size()) {
+          frames.back().second++;
+          int d = reversed ? children[children.size() - 1 - next]
+                           : children[next];
+          if (!visited[d]) {
+            visited[d] = true;
+            frames.push_back(std::make_pair(d, 0));
+          }
+          continue;
+        }
+
+        // All children are labeled; c's interval covers theirs.
+        frames.pop_back();
+        int low = post;
+        for (auto& d : children)
+          low = std::min(low, lows[d * kNumIntervals + i]);
+        lows[c * kNumIntervals + i] = low;
+        posts[c * kNumIntervals + i] = post++;
+      }
+    }
+  }
+}
+
+inline bool ComponentIndex::mayReachComponent(const int c,
+                                              const int d) const {
+  if (c == d)
+    return true;
+  if (c > d)  // Edges never lead to lower-numbered components.
+    return false;
+  for (int i = 0; i < kNumIntervals; i++) {
+    if (lows[d * kNumIntervals + i] < lows[c * kNumIntervals + i] ||
+        posts[d * kNumIntervals + i] > posts[c * kNumIntervals + i])
+      return false;
+  }
+  return true;
+}
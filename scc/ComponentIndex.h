@@ -0,0 +1,200 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef COMPONENTINDEX_H_
+#define COMPONENTINDEX_H_
+
+#include <vector>
+#include "../graph/CompactDirectedGraph.h"
+#include "../graph/StaticGraph.h"
+
+/*
+ * Reachability index over the strongly connected components of a graph
+ * whose vertices are of primitive type 'int', from 0 to V - 1.
+ *
+ * Components are numbered in topological order of the condensation (the
+ * DAG with one node per component), so an edge never leads from one
+ * component to a lower-numbered one. On top of that, every component gets
+ * kNumIntervals interval labels from depth-first traversals of the
+ * condensation: if component c reaches d, d's interval is contained in
+ * c's in every traversal. Together these reject most unreachable pairs
+ * in constant time, without any search. A pair that passes all tests is
+ * only possibly reachable.
+ *
+ * Components are found in parallel by the forward-backward algorithm:
+ * after trimming vertices without incoming or outgoing edges, the
+ * vertices reached both forwards and backwards from a pivot form one
+ * component, and the vertices reached in only one direction (or neither)
+ * form independent subproblems. Small subproblems are finished by
+ * Tarjan's algorithm.
+*/
+class ComponentIndex {
+ public:
+  /*
+   * Number of interval labels per component.
+  */
+  static const int kNumIntervals = 2;
+
+  /*
+   * Ctor.
+   * Builds the index of 'graph', which has 'V' vertices, using
+   * 'numThreads' threads (or one per hardware thread if 0).
+   *
+   * Read "graph/StaticGraph.h" for the requirements on 'GraphType'.
+  */
+  template <typename GraphType>
+  ComponentIndex(const GraphType& graph, const int V,
+                 const int numThreads = 0);
+
+  /*
+   * Dtor.
+  */
+  ~ComponentIndex() { }
+
+  /*
+   * Returns the number of strongly connected components.
+  */
+  int numComponents() const { return numComponents_; }
+
+  /*
+   * Returns the component of the given vertex. Components are numbered
+   * from 0, in topological order of the condensation.
+  */
+  int component(const int v) const { return components_[v]; }
+
+  /*
+   * Returns false if component 'd' is certainly not reachable from
+   * component 'c', true if it may be.
+  */
+  bool mayReachComponent(const int c, const int d) const;
+
+  /*
+   * Returns false if 't' is certainly not reachable from 's', true if it
+   * may be (and always if both are in the same component).
+  */
+  bool mayReach(const int s, const int t) const {
+    return mayReachComponent(components_[s], components_[t]);
+  }
+
+ private:
+  int numComponents_;
+  std::vector<int> components_;
+
+  /*
+   * Component c's interval in traversal i is from lows[c * kNumIntervals
+   * + i] to posts[c * kNumIntervals + i], both included.
+  */
+  std::vector<int> lows;
+  std::vector<int> posts;
+
+  /*
+   * Finds the components and numbers them topologically; then labels
+   * the condensation, whose edges are given in 'dag' (by component).
+  */
+  template <typename GraphType>
+  void findComponents(const GraphType& graph, const int V,
+                      const int numThreads);
+  void labelCondensation(const std::vector<std::vector<int>>& dag);
+};
+
+/*
+ * Range over the arcs of an ArcRange that pass a reachability test
+ * against a fixed component: with 'forward', arcs whose target component
+ * may reach it, otherwise arcs whose target component it may reach.
+*/
+class ComponentArcRange {
+ public:
+  class Iterator {
+   public:
+    Iterator(const Arc<int>* arc, const Arc<int>* end,
+             const ComponentIndex* index, const int component,
+             const bool forward) :
+            arc_(arc), end_(end), index_(index), component_(component),
+            forward_(forward) { skip(); }
+
+    const Arc<int>& operator*() const { return *arc_; }
+    Iterator& operator++() {
+      arc_++;
+      skip();
+      return *this;
+    }
+    bool operator!=(const Iterator& other) const { return arc_ != other.arc_; }
+
+   private:
+    void skip() {
+      while (arc_ != end_ && !passes(index_->component(arc_->to)))
+        arc_++;
+    }
+    bool passes(const int c) const {
+      return forward_ ? index_->mayReachComponent(c, component_)
+                      : index_->mayReachComponent(component_, c);
+    }
+
+    const Arc<int>* arc_;
+    const Arc<int>* end_;
+    const ComponentIndex* index_;
+    int component_;
+    bool forward_;
+  };
+
+  ComponentArcRange(const ArcRange<int>& arcs, const ComponentIndex* index,
+                    const int component, const bool forward) :
+                   arcs_(arcs), index_(index), component_(component),
+                   forward_(forward) { }
+
+  Iterator begin() const {
+    return Iterator(arcs_.begin(), arcs_.end(), index_, component_,
+                    forward_);
+  }
+  Iterator end() const {
+    return Iterator(arcs_.end(), arcs_.end(), index_, component_, forward_);
+  }
+
+ private:
+  ArcRange<int> arcs_;
+  const ComponentIndex* index_;
+  int component_;
+  bool forward_;
+};
+
+/*
+ * View of a CompactDirectedGraph for one (start, end) query, leaving out
+ * arcs into components that cannot be on any path from start to end:
+ * outgoing arcs must lead to a component that may reach the end, and
+ * incoming arcs must come from a component the start may reach. Meets
+ * the requirements in "graph/StaticGraph.h", like ArcFlagsView.
+*/
+class ComponentView {
+ public:
+  /*
+   * Ctor.
+   * The graph and index must outlive the view.
+  */
+  ComponentView(const CompactDirectedGraph& graph,
+                const ComponentIndex& index, const int start, const int end) :
+               graph_(graph), index_(index),
+               startComponent(index.component(start)),
+               endComponent(index.component(end)) { }
+
+  ComponentArcRange outgoingNeighbors(const int& v) const {
+    return ComponentArcRange(graph_.outgoingNeighbors(v), &index_,
+                             endComponent, true);
+  }
+  ComponentArcRange incomingNeighbors(const int& v) const {
+    return ComponentArcRange(graph_.incomingNeighbors(v), &index_,
+                             startComponent, false);
+  }
+
+ private:
+  const CompactDirectedGraph& graph_;
+  const ComponentIndex& index_;
+  int startComponent;
+  int endComponent;
+};
+
+#include "ComponentIndex.cpp"
+
+#endif  // COMPONENTINDEX_H_
@@ -0,0 +1,154 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <assert.h>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "ComponentIndex.h"
+#include "../graph/CompactDirectedGraph.h"
+#include "../graph/WeightedDirectedGraph.h"
+#include "../solver/BiDijkstraSolver.h"
+
+/*
+ * Returns which vertices are reachable from 's' (or reach 's' if not
+ * 'forward').
+*/
+static std::vector<bool> reachable(const CompactDirectedGraph& graph,
+                                   const int s, const bool forward) {
+  std::vector<bool> seen(graph.numVertices(), false);
+  std::deque<int> queue(1, s);
+  seen[s] = true;
+  while (!queue.empty()) {
+    int u = queue.front();
+    queue.pop_front();
+    auto arcs = forward ? graph.outgoingNeighbors(u)
+                        : graph.incomingNeighbors(u);
+    for (auto& arc : arcs) {
+      if (!seen[arc.to]) {
+        seen[arc.to] = true;
+        queue.push_back(arc.to);
+      }
+    }
+  }
+  return seen;
+}
+
+int main(int argc, char* argv[]) {
+  /*
+  ////////////////// Small graph. //////////////////
+  */
+  WeightedDirectedGraph wdg(7);
+  wdg.addEdge(0, 1, 2);
+  wdg.addEdge(0, 2, 1);
+  wdg.addEdge(1, 2, 5);
+  wdg.addEdge(1, 3, 11);
+  wdg.addEdge(1, 4, 3);
+  wdg.addEdge(2, 5, 15);
+  wdg.addEdge(3, 4, 2);
+  wdg.addEdge(4, 2, 1);
+  wdg.addEdge(4, 5, 4);
+  wdg.addEdge(4, 6, 5);
+  wdg.addEdge(6, 3, 1);
+  wdg.addEdge(6, 5, 1);
+
+  // Components: {0}, {1}, {2}, {3, 4, 6}, {5}.
+  ComponentIndex small(wdg, 7);
+  assert(5 == small.numComponents());
+  assert(small.component(3) == small.component(4));
+  assert(small.component(4) == small.component(6));
+  assert(small.component(0) < small.component(1));
+  assert(small.component(1) < small.component(4));
+  assert(small.component(4) < small.component(5));
+  assert(small.mayReach(6, 3));
+  assert(!small.mayReach(5, 0));
+  assert(!small.mayReach(2, 4));
+
+  static_assert(IsStaticGraph<ComponentView, int>::value,
+                "ComponentView must be usable by the solvers.");
+  CompactDirectedGraph cdg(wdg);
+  ComponentView view(cdg, small, 0, 6);
+  BiDijkstraSolver<int, ComponentView> viewSolver(view, 0, 6, 10);
+  assert(1 == viewSolver.outcome());
+  assert(std::vector<int>({0, 1, 4, 6}) == viewSolver.solution());
+
+  /*
+  ////////////////// Random graph with many components. //////////////////
+  */
+  // Dense clusters of random sizes, chained by sparse forward edges, with
+  // a few edges back from a later cluster merging some of them.
+  const int V = 20000;
+  std::mt19937 rng(11);
+  WeightedDirectedGraph clusters(V);
+  int begin = 0;
+  while (begin < V) {
+    int size = std::min(V - begin, 1 + static_cast<int>(rng() % 40));
+    for (int i = 0; i < size; i++) {
+      if (rng() % 8 != 0)  // Leave some clusters open.
+        clusters.addEdge(begin + i, begin + (i + 1) % size, 1);
+      clusters.addEdge(begin + i, begin + rng() % size, 1);
+    }
+    begin += size;
+  }
+  for (int i = 0; i < V; i++) {
+    int a = rng() % V, b = rng() % V;
+    if (a > b)
+      std::swap(a, b);
+    if (rng() % 50 == 0)
+      std::swap(a, b);
+    clusters.addEdge(a, b, 1);
+  }
+  CompactDirectedGraph graph(clusters);
+
+  ComponentIndex index(graph, V, 4);
+  ComponentIndex serialIndex(graph, V, 1);
+  assert(index.numComponents() == serialIndex.numComponents());
+  std::cout << "Components: " << index.numComponents() << std::endl;
+
+  for (int u = 0; u < V; u++) {
+    for (auto& arc : graph.outgoingNeighbors(u))
+      assert(index.component(u) <= index.component(arc.to));
+  }
+
+  int rejected = 0, unreachable = 0;
+  for (int q = 0; q < 100; q++) {
+    int s = rng() % V;
+    std::vector<bool> fromS = reachable(graph, s, true);
+    std::vector<bool> toS = reachable(graph, s, false);
+    for (int t = 0; t < V; t++) {
+      if (fromS[t]) {
+        assert(index.mayReach(s, t));
+      } else {
+        unreachable++;
+        if (!index.mayReach(s, t))
+          rejected++;
+      }
+      // Same component exactly when mutually reachable.
+      assert((index.component(s) == index.component(t)) ==
+             (fromS[t] && toS[t]));
+    }
+  }
+  std::cout << "Unreachable pairs rejected: " << rejected << " of "
+            << unreachable << std::endl;
+
+  long plainStates = 0, viewStates = 0;
+  for (int q = 0; q < 200; q++) {
+    int s = rng() % V, t = rng() % V;
+    if (!index.mayReach(s, t))
+      continue;
+    BiDijkstraSolver<int, CompactDirectedGraph> plain(graph, s, t, 10);
+    ComponentView bounded(graph, index, s, t);
+    BiDijkstraSolver<int, ComponentView> boundedSolver(bounded, s, t, 10);
+    assert(plain.outcome() == boundedSolver.outcome());
+    assert(plain.solutionWeight() == boundedSolver.solutionWeight());
+    plainStates += plain.numStatesExplored();
+    viewStates += boundedSolver.numStatesExplored();
+  }
+  std::cout << "States explored: " << plainStates << " plain, "
+            << viewStates << " bounded to relevant components." << std::endl;
+}
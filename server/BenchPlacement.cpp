@@ -0,0 +1,219 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+/*
+ * Benchmark of graph memory placement: regular pages vs. transparent
+ * huge pages, and one shared graph vs. per-NUMA-node replicas with
+ * pinned threads.
+ *
+ * Each configuration runs two workloads on every thread:
+ *   - random walks over the adjacency arrays, reading every arc of each
+ *     visited vertex (bound by memory latency, TLB misses included);
+ *   - distance-only BiDijkstraSolver queries between random vertices.
+ *
+ * Usage:
+ *   bench_placement [--vertices V] [--degree D] [--threads N]
+ *                   [--steps STEPS] [--queries Q]
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Numa.h"
+#include "../graph/CompactDirectedGraph.h"
+#include "../graph/HugePages.h"
+#include "../solver/BiDijkstraSolver.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * Returns the first line of the given file, or "" if it cannot be read.
+*/
+static std::string firstLine(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+/*
+ * Returns the process's memory backed by transparent huge pages, in kB,
+ * or -1 if unknown.
+*/
+static long anonHugePagesKb() {
+  std::ifstream file("/proc/self/smaps_rollup");
+  std::string line;
+  long value;
+  while (std::getline(file, line)) {
+    if (sscanf(line.c_str(), "AnonHugePages: %ld", &value) == 1)
+      return value;
+  }
+  return -1;
+}
+
+/*
+ * Random walk of 'steps' steps; returns a checksum so that the reads
+ * cannot be optimized out.
+*/
+static double walk(const CompactDirectedGraph& graph, const long steps,
+                   const unsigned seed) {
+  std::mt19937 rng(seed);
+  const int V = graph.numVertices();
+  int v = rng() % V;
+  double sum = 0;
+  for (long i = 0; i < steps; i++) {
+    auto arcs = graph.outgoingNeighbors(v);
+    for (auto& arc : arcs)
+      sum += arc.weight;
+    // Mostly jump anywhere, as a search's fringe does.
+    if (arcs.size() > 0 && rng() % 4 == 0)
+      v = (arcs.begin() + rng() % arcs.size())->to;
+    else
+      v = rng() % V;
+  }
+  return sum;
+}
+
+/*
+ * Runs both workloads on 'threads' threads; thread i uses graphs[i %
+ * graphs.size()] and, if 'pin', is pinned to nodes[i % nodes.size()].
+ * Prints the throughput of each.
+*/
+static void run(const std::string& name,
+                const std::vector<const CompactDirectedGraph*>& graphs,
+                const std::vector<NumaNode>& nodes, const bool pin,
+                const int threads, const long steps, const int queries) {
+  for (int workload = 0; workload < 2; workload++) {
+    std::vector<std::thread> pool;
+    std::vector<double> sums(threads);
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < threads; t++) {
+      pool.push_back(std::thread([&, t] {
+        if (pin)
+          pinToCpus(nodes[t % nodes.size()].cpus);
+        const CompactDirectedGraph& graph = *graphs[t % graphs.size()];
+        if (workload == 0) {
+          sums[t] = walk(graph, steps, t + 1);
+          return;
+        }
+        std::mt19937 rng(t + 1);
+        for (int q = 0; q < queries; q++) {
+          int s = rng() % graph.numVertices();
+          int e = rng() % graph.numVertices();
+          BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, s, e,
+                                                             60, true);
+          sums[t] += solver.solutionWeight();
+        }
+      }));
+    }
+    for (auto& thread : pool)
+      thread.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start)
+                         .count();
+
+    if (workload == 0) {
+      printf("%-32s walk:    %8.1f M steps/s\n", name.c_str(),
+             threads * steps / seconds / 1e6);
+    } else {
+      printf("%-32s queries: %8.1f queries/s\n", name.c_str(),
+             threads * queries / seconds);
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int V = 1 << 21, degree = 4, queries = 20;
+  int threads = std::thread::hardware_concurrency();
+  long steps = 2000000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--vertices") {
+      V = atoi(argv[i + 1]);
+    } else if (arg == "--degree") {
+      degree = atoi(argv[i + 1]);
+    } else if (arg == "--threads") {
+      threads = atoi(argv[i + 1]);
+    } else if (arg == "--steps") {
+      steps = atol(argv[i + 1]);
+    } else if (arg == "--queries") {
+      queries = atoi(argv[i + 1]);
+    } else {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return 1;
+    }
+  }
+  if (threads < 1)
+    threads = 1;
+
+  std::vector<NumaNode> nodes = numaNodes();
+  std::string thp = firstLine("/sys/kernel/mm/transparent_hugepage/enabled");
+  printf("%d vertices, %d arcs, %d threads, %zu NUMA node(s), THP: %s\n",
+         V, V * degree, threads, nodes.size(),
+         thp.empty() ? "unavailable" : thp.c_str());
+
+  std::vector<WeightedEdge<int>> edges;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> weight(1.0, 100.0);
+  for (int v = 0; v < V; v++) {
+    edges.push_back(WeightedEdge<int>(v, (v + 1) % V, weight(rng)));
+    for (int i = 1; i < degree; i++)
+      edges.push_back(WeightedEdge<int>(v, rng() % V, weight(rng)));
+  }
+
+  // Regular pages, one shared graph.
+  setHugePageMode(kHugePagesOff);
+  {
+    unique_ptr<CompactDirectedGraph> graph(new CompactDirectedGraph(V,
+                                                                    edges));
+    long kb = anonHugePagesKb();
+    if (kb >= 0)
+      printf("(%ld kB of memory in huge pages)\n", kb);
+    run("regular pages, shared", {graph.get()}, nodes, false, threads,
+        steps, queries);
+  }
+
+  // Huge pages, one shared graph.
+  setHugePageMode(kHugePagesOn);
+  {
+    unique_ptr<CompactDirectedGraph> graph(new CompactDirectedGraph(V,
+                                                                    edges));
+    long kb = anonHugePagesKb();
+    if (kb >= 0)
+      printf("(%ld kB of memory in huge pages)\n", kb);
+    run("huge pages, shared", {graph.get()}, nodes, false, threads,
+        steps, queries);
+  }
+
+  // Huge pages, one replica per node built on that node, pinned threads.
+  if (nodes.size() > 1) {
+    CompactDirectedGraph source(V, edges);
+    std::vector<unique_ptr<CompactDirectedGraph>> replicas(nodes.size());
+    std::vector<std::thread> copiers;
+    for (size_t n = 0; n < nodes.size(); n++) {
+      copiers.push_back(std::thread([&, n] {
+        pinToCpus(nodes[n].cpus);
+        replicas[n].reset(new CompactDirectedGraph(source));
+      }));
+    }
+    for (auto& copier : copiers)
+      copier.join();
+    std::vector<const CompactDirectedGraph*> graphs;
+    for (auto& replica : replicas)
+      graphs.push_back(replica.get());
+    run("huge pages, per-node replicas", graphs, nodes, true, threads,
+        steps, queries);
+  } else {
+    printf("%-32s skipped: single NUMA node\n",
+           "huge pages, per-node replicas");
+  }
+  return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef GRAPHLOADER_H_
+#define GRAPHLOADER_H_
+
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include "../graph/WeightedDirectedGraph.h"
+
+/*
+ * Loads a graph from a plain-text edge list. The first (non-comment)
+ * line holds the number of vertices; every following line holds one
+ * edge as "from to weight". Lines starting with '#' are ignored.
+ * Returns 'nullptr' if the file cannot be read or is malformed.
+*/
+inline unique_ptr<WeightedDirectedGraph> loadGraph(const std::string& path) {
+  std::ifstream in(path);
+  if (!in)
+    return nullptr;
+
+  unique_ptr<WeightedDirectedGraph> graph;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream fields(line);
+    if (!graph) {
+      int V;
+      if (!(fields >> V) || V < 0)
+        return nullptr;
+      graph.reset(new WeightedDirectedGraph(V));
+      continue;
+    }
+    int p, q;
+    double weight;
+    if (!(fields >> p >> q >> weight) || p < 0 || q < 0 ||
+        p >= graph->numVertices() || q >= graph->numVertices() || weight < 0)
+      return nullptr;
+    graph->addEdge(p, q, weight);
+  }
+  return graph;
+}
+
+/*
+ * Generates a random graph with 'V' vertices and 'E' edges, with weights
+ * uniformly drawn from [1, 100). Every vertex i also gets an edge to
+ * vertex i + 1 (mod V) so that all queries are solvable.
+*/
+inline unique_ptr<WeightedDirectedGraph> randomGraph(const int V, const int E,
+                                                     const unsigned seed) {
+  unique_ptr<WeightedDirectedGraph> graph(new WeightedDirectedGraph(V));
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> vertex(0, V - 1);
+  std::uniform_real_distribution<double> weight(1.0, 100.0);
+  for (int i = 0; i < V; i++)
+    graph->addEdge(i, (i + 1) % V, weight(rng));
+  for (int i = V; i < E; i++)
+    graph->addEdge(vertex(rng), vertex(rng), weight(rng));
+  return graph;
+}
+
+#endif  // GRAPHLOADER_H_
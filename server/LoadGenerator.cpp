@@ -0,0 +1,172 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+/*
+ * Load generator for the query server.
+ *
+ * Opens several connections, keeps up to 'window' random queries in
+ * flight on each, and reports throughput and latency percentiles.
+ * Raise --connections/--window until throughput stops growing to find
+ * the server's saturation throughput. Finishes by printing the server's
+ * own counters.
+ *
+ * Usage:
+ *   load_generator (--unix PATH | --port N) --vertices V
+ *                  [--connections N] [--requests N] [--window N]
+ *                  [--seed N] [--path 0|1]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Protocol.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * Runs one connection's share of the load. Latencies (in microseconds)
+ * are appended to 'latencies'. Returns false on connection errors.
+*/
+static bool runConnection(const std::string& unixPath, const int port,
+                          const int vertices, const int requests,
+                          const int window, const unsigned seed,
+                          const bool withPath,
+                          std::vector<double>* latencies) {
+  int fd = connectTo(unixPath, port);
+  if (fd < 0)
+    return false;
+
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> vertex(0, vertices - 1);
+  std::vector<Clock::time_point> sentAt(requests);
+  LineReader lines(fd);
+  std::string line;
+  int sent = 0, received = 0;
+  bool ok = true;
+
+  while (received < requests) {
+    // Top up the window; all new requests go out in one write.
+    std::string out;
+    while (sent < requests && sent - received < window) {
+      out += "{\"id\":" + std::to_string(sent) +
+             ",\"start\":" + std::to_string(vertex(rng)) +
+             ",\"end\":" + std::to_string(vertex(rng)) +
+             ",\"path\":" + (withPath ? "1" : "0") + "}\n";
+      sentAt[sent++] = Clock::now();
+    }
+    if (!out.empty() && !writeAll(fd, out.data(), out.size())) {
+      ok = false;
+      break;
+    }
+
+    if (!lines.next(&line)) {
+      ok = false;
+      break;
+    }
+    double id;
+    if (!jsonNumber(line, "id", &id) || id < 0 || id >= sent) {
+      ok = false;
+      break;
+    }
+    latencies->push_back(std::chrono::duration<double, std::micro>(
+                             Clock::now() - sentAt[static_cast<int>(id)])
+                             .count());
+    received++;
+  }
+  close(fd);
+  return ok;
+}
+
+int main(int argc, char* argv[]) {
+  std::string unixPath;
+  int port = -1, vertices = 0, connections = 4, requests = 10000, window = 16;
+  unsigned seed = 1;
+  bool withPath = true;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--unix" && i + 1 < argc) {
+      unixPath = argv[++i];
+    } else if (arg == "--port" && i + 1 < argc) {
+      port = atoi(argv[++i]);
+    } else if (arg == "--vertices" && i + 1 < argc) {
+      vertices = atoi(argv[++i]);
+    } else if (arg == "--connections" && i + 1 < argc) {
+      connections = atoi(argv[++i]);
+    } else if (arg == "--requests" && i + 1 < argc) {
+      requests = atoi(argv[++i]);
+    } else if (arg == "--window" && i + 1 < argc) {
+      window = atoi(argv[++i]);
+    } else if (arg == "--seed" && i + 1 < argc) {
+      seed = atoi(argv[++i]);
+    } else if (arg == "--path" && i + 1 < argc) {
+      withPath = atoi(argv[++i]) != 0;
+    } else {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return 1;
+    }
+  }
+  if ((unixPath.empty() && port < 0) || vertices <= 0 || connections < 1 ||
+      requests < 1 || window < 1) {
+    std::cerr << "Usage: " << argv[0]
+              << " (--unix PATH | --port N) --vertices V"
+              << " [--connections N] [--requests N] [--window N]"
+              << " [--seed N] [--path 0|1]" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::vector<double>> latencies(connections);
+  std::vector<std::thread> threads;
+  std::vector<char> ok(connections);
+  Clock::time_point begin = Clock::now();
+  for (int i = 0; i < connections; i++) {
+    threads.push_back(std::thread([&, i] {
+      ok[i] = runConnection(unixPath, port, vertices, requests, window,
+                            seed + i, withPath, &latencies[i]);
+    }));
+  }
+  for (auto& t : threads)
+    t.join();
+  double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+
+  std::vector<double> all;
+  for (int i = 0; i < connections; i++) {
+    if (!ok[i])
+      std::cerr << "Connection " << i << " failed" << std::endl;
+    all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+  }
+  if (all.empty())
+    return 1;
+  std::sort(all.begin(), all.end());
+  double mean = 0;
+  for (auto& l : all)
+    mean += l;
+  mean /= all.size();
+
+  std::cout << "Requests: " << all.size() << std::endl;
+  std::cout << "Throughput: " << all.size() / elapsed << " (queries/second)"
+            << std::endl;
+  std::cout << "Latency mean/p50/p99/max: " << mean << " / "
+            << all[all.size() / 2] << " / "
+            << all[std::min(all.size() - 1, all.size() * 99 / 100)] << " / "
+            << all.back() << " (microseconds)" << std::endl;
+
+  // Ask the server for its own view of the run.
+  int fd = connectTo(unixPath, port);
+  std::string stats = "{\"id\":0,\"stats\":1}\n";
+  std::string line;
+  LineReader lines(fd);
+  if (fd >= 0 && writeAll(fd, stats.data(), stats.size()) &&
+      lines.next(&line))
+    std::cout << "Server: " << line << std::endl;
+  if (fd >= 0)
+    close(fd);
+  return 0;
+}
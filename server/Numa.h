@@ -0,0 +1,104 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef NUMA_H_
+#define NUMA_H_
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Minimal NUMA topology support, read from Linux's sysfs, without any
+ * library dependency.
+ *
+ * Memory placement relies on the kernel's default first-touch policy:
+ * memory allocated and filled by a thread pinned to a node's CPUs is
+ * placed on that node. So a per-node replica of a read-only structure is
+ * simply a copy made by a thread pinned to that node.
+*/
+
+/*
+ * A NUMA node and the CPUs it holds.
+*/
+struct NumaNode {
+  int id;
+  std::vector<int> cpus;
+};
+
+/*
+ * Parses a CPU list such as "0-3,8,10-11".
+*/
+inline std::vector<int> parseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    int first, last;
+    if (sscanf(range.c_str(), "%d-%d", &first, &last) == 2) {
+      for (int cpu = first; cpu <= last; cpu++)
+        cpus.push_back(cpu);
+    } else if (sscanf(range.c_str(), "%d", &first) == 1) {
+      cpus.push_back(first);
+    }
+  }
+  return cpus;
+}
+
+/*
+ * Returns the machine's NUMA nodes that have CPUs. Without NUMA support
+ * in sysfs, returns a single node holding every CPU this process may run
+ * on, so callers need no special case.
+*/
+inline std::vector<NumaNode> numaNodes() {
+  std::vector<NumaNode> nodes;
+  for (int id = 0; id < 1024; id++) {
+    std::ifstream file("/sys/devices/system/node/node" +
+                       std::to_string(id) + "/cpulist");
+    if (!file)
+      continue;
+    std::string list;
+    std::getline(file, list);
+    NumaNode node = {id, parseCpuList(list)};
+    if (!node.cpus.empty())
+      nodes.push_back(node);
+  }
+
+  if (nodes.empty()) {
+    NumaNode all = {0, std::vector<int>()};
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set))
+          all.cpus.push_back(cpu);
+      }
+    }
+    nodes.push_back(all);
+  }
+  return nodes;
+}
+
+/*
+ * Restricts the calling thread to the given CPUs.
+ * Returns true on success, false otherwise (the thread is left as is).
+*/
+inline bool pinToCpus(const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto& cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &set);
+  }
+  return !cpus.empty() &&
+         pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#endif  // NUMA_H_
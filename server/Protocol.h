@@ -0,0 +1,209 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <string>
+
+/*
+ * Helpers shared by the query server and the load generator.
+ *
+ * The protocol is JSON lines: every request and every response is a
+ * single flat JSON object terminated by '\n'. Requests look like
+ *
+ *   {"id": 7, "start": 0, "end": 6}
+ *   {"id": 8, "start": 0, "end": 6, "path": 0}   (weight only)
+ *   {"id": 9, "stats": 1}                         (server counters)
+ *   {"id": 10, "start": 0, "end": 6, "max_distance": 5000,
+ *    "max_settled": 10000}                        (bounded search)
+ *
+ * and responses echo the request's "id", which must be an integer of at
+ * most 2^53 in magnitude ("id": null answers a request whose id is not).
+ * Responses on one connection may arrive out of order. A bounded search
+ * that gives up answers with "outcome": -2 and what it knows of the
+ * weight, "lower_bound" and "best_weight" (see SearchBounds in
+ * "solver/BiDijkstraSolver.h"). The
+ * bounds must be finite and non-negative, and "max_settled" must fit an
+ * int; other values get a "bad request" error.
+*/
+
+/*
+ * Looks up the numeric field 'key' in a flat JSON object.
+ * Returns true and stores the number in 'value' if present.
+*/
+inline bool jsonNumber(const std::string& line, const char* key,
+                       double* value) {
+  std::string quoted = std::string("\"") + key + "\"";
+  size_t pos = line.find(quoted);
+  if (pos == std::string::npos)
+    return false;
+  pos = line.find(':', pos + quoted.size());
+  if (pos == std::string::npos)
+    return false;
+  const char* begin = line.c_str() + pos + 1;
+  char* end;
+  *value = strtod(begin, &end);
+  return end != begin;
+}
+
+/*
+ * Writes all of 'data' to the socket. Returns false on error.
+*/
+inline bool writeAll(int fd, const char* data, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+/*
+ * Opens a listening socket on the Unix domain socket 'unixPath', or on
+ * TCP loopback port 'port' if 'unixPath' is empty. Returns -1 on error.
+*/
+inline int listenOn(const std::string& unixPath, const int port) {
+  int fd;
+  if (!unixPath.empty()) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, unixPath.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(unixPath.c_str());
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 ||
+        bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+      return -1;
+  } else {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    if (fd < 0)
+      return -1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+      return -1;
+  }
+  if (listen(fd, 128) < 0)
+    return -1;
+  return fd;
+}
+
+/*
+ * Connects to a server listening as described for listenOn().
+ * Returns -1 on error.
+*/
+inline int connectTo(const std::string& unixPath, const int port) {
+  int fd;
+  int result;
+  if (!unixPath.empty()) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, unixPath.c_str(), sizeof(addr.sun_path) - 1);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+      return -1;
+    result = connect(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                     sizeof(addr));
+  } else {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+      return -1;
+    result = connect(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                     sizeof(addr));
+  }
+  if (result < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/*
+ * Longest line accepted by LineReader by default, in bytes.
+*/
+static const size_t kMaxLineLength = 1 << 20;
+
+/*
+ * Buffered reader splitting a socket's byte stream into lines.
+*/
+class LineReader {
+ public:
+  explicit LineReader(int fd, const size_t maxLength = kMaxLineLength) :
+                     fd_(fd), pos_(0), maxLength_(maxLength),
+                     tooLong_(false) { }
+
+  /*
+   * Reads the next line (without the '\n') into 'line'.
+   * Returns false once the peer has closed the connection, or once a line
+   * exceeds the maximum length (see tooLong()); nothing more is read then.
+  */
+  bool next(std::string* line) {
+    if (tooLong_)
+      return false;
+    while (true) {
+      size_t newline = buffer_.find('\n', pos_);
+      if (newline != std::string::npos && newline - pos_ <= maxLength_) {
+        line->assign(buffer_, pos_, newline - pos_);
+        pos_ = newline + 1;
+        return true;
+      }
+      if (newline != std::string::npos ||
+          buffer_.size() - pos_ > maxLength_) {
+        tooLong_ = true;
+        buffer_.clear();
+        pos_ = 0;
+        return false;
+      }
+      buffer_.erase(0, pos_);
+      pos_ = 0;
+      char chunk[65536];
+      ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      buffer_.append(chunk, n);
+    }
+  }
+
+  /*
+   * Returns true if reading stopped because a line was too long.
+  */
+  bool tooLong() const { return tooLong_; }
+
+ private:
+  int fd_;
+  std::string buffer_;
+  size_t pos_;
+  size_t maxLength_;
+  bool tooLong_;
+};
+
+#endif  // PROTOCOL_H_
@@ -0,0 +1,596 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+/*
+ * Standalone shortest-path query server.
+ *
+ * Loads one graph and answers BiDijkstraSolver queries over a Unix domain
+ * socket or TCP loopback, using the JSON-lines protocol described in
+ * "Protocol.h". One reader thread per connection splits incoming lines;
+ * a pool of workers takes them off a shared queue in batches, solves
+ * identical queries within a batch only once, and writes each batch's
+ * responses with one write per connection. Every search starts from fresh
+ * state (see README.md, "Query Server").
+ *
+ * With --labels, queries that do not ask for the path are answered from
+ * a hub labeling index (see "hublabels/HubLabels.h") instead of a search.
+ *
+ * A strongly-connected-component index (see "scc/ComponentIndex.h") is
+ * built at startup. Queries it proves unsolvable are answered without a
+ * search; the others only search components that can be on a path.
+ *
+ * With --huge-pages, the graph's arrays are advised for transparent huge
+ * pages (see "graph/HugePages.h"). With --numa, on machines with several
+ * NUMA nodes, the graph and component index are replicated on every node
+ * and each worker is pinned to one node and reads its local replica
+ * (see "Numa.h"); on a single node, the option has no effect.
+ *
+ * Built with -DBIDIJKSTRA_TRACE (make query_server_traced), --trace
+ * records the searches of every query (or one in every N, with
+ * --trace-sampling) and writes them to the given file on shutdown: as
+ * Chrome trace JSON if its name ends in ".json", in the binary format of
+ * "trace/SearchTrace.h" otherwise.
+ *
+ * Usage:
+ *   query_server (--graph FILE | --random V E SEED)
+ *                (--unix PATH | --port N)
+ *                [--workers N] [--batch N] [--timeout SECONDS]
+ *                [--labels INDEX_FILE] [--huge-pages] [--numa]
+ *                [--trace FILE] [--trace-sampling N]
+*/
+
+#include <signal.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "GraphLoader.h"
+#include "Numa.h"
+#include "Protocol.h"
+#include "../graph/CompactDirectedGraph.h"
+#include "../graph/HugePages.h"
+#include "../hublabels/HubLabels.h"
+#include "../scc/ComponentIndex.h"
+#include "../solver/BiDijkstraSolver.h"
+#include "../trace/SearchTrace.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * A client connection. The socket is closed once the reader thread and
+ * every pending request are done with it.
+*/
+struct Connection {
+  explicit Connection(int fd) : fd(fd) { }
+  ~Connection() { close(fd); }
+  int fd;
+  std::mutex writeMutex;  // Serializes responses from different workers.
+};
+
+/*
+ * A request line waiting to be handled, and when it arrived.
+*/
+struct Request {
+  std::shared_ptr<Connection> connection;
+  std::string line;
+  Clock::time_point arrival;
+};
+
+/*
+ * Blocking multi-producer/multi-consumer queue of requests.
+*/
+class RequestQueue {
+ public:
+  void push(Request request) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      requests_.push_back(std::move(request));
+    }
+    ready_.notify_one();
+  }
+
+  /*
+   * Blocks until at least one request is queued, then moves up to
+   * 'maxBatch' requests into 'batch'.
+  */
+  void popBatch(std::vector<Request>* batch, const size_t maxBatch) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return !requests_.empty(); });
+    while (!requests_.empty() && batch->size() < maxBatch) {
+      batch->push_back(std::move(requests_.front()));
+      requests_.pop_front();
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<Request> requests_;
+};
+
+/*
+ * Throughput/latency counters, shared by all workers.
+ * Latencies are bucketed by powers of two microseconds.
+*/
+struct Counters {
+  static const int kBuckets = 32;
+
+  Counters() : started(Clock::now()) {
+    for (int i = 0; i < kBuckets; i++)
+      histogram[i] = 0;
+  }
+
+  void recordLatency(const Clock::duration& latency) {
+    unsigned long long ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    latencyNs += ns;
+    unsigned long long prevMax = maxLatencyNs;
+    while (ns > prevMax && !maxLatencyNs.compare_exchange_weak(prevMax, ns)) {
+    }
+    int bucket = 0;
+    for (unsigned long long us = ns / 1000; us > 1 && bucket < kBuckets - 1;
+         us >>= 1)
+      bucket++;
+    histogram[bucket]++;
+  }
+
+  /*
+   * Upper bound (in microseconds) of the latency bucket holding the
+   * given percentile.
+  */
+  unsigned long long percentileUs(const double percentile) const {
+    unsigned long long total = 0;
+    for (int i = 0; i < kBuckets; i++)
+      total += histogram[i];
+    unsigned long long seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+      seen += histogram[i];
+      if (total > 0 && seen >= percentile * total)
+        return 2ULL << i;
+    }
+    return 0;
+  }
+
+  Clock::time_point started;
+  std::atomic<unsigned long long> requests{0};
+  std::atomic<unsigned long long> errors{0};
+  std::atomic<unsigned long long> batches{0};
+  std::atomic<unsigned long long> deduplicated{0};
+  std::atomic<unsigned long long> rejected{0};
+  std::atomic<unsigned long long> statesExplored{0};
+  std::atomic<unsigned long long> latencyNs{0};
+  std::atomic<unsigned long long> maxLatencyNs{0};
+  std::atomic<unsigned long long> histogram[kBuckets];
+};
+
+/*
+ * Formats the counters as the body of a JSON object (without braces).
+*/
+static std::string statsJson(const Counters& counters) {
+  double uptime = std::chrono::duration<double>(
+                      Clock::now() - counters.started).count();
+  unsigned long long requests = counters.requests;
+  unsigned long long batches = counters.batches;
+  char buffer[512];
+  snprintf(buffer, sizeof(buffer),
+           "\"uptime_s\":%.3f,\"requests\":%llu,\"errors\":%llu,"
+           "\"batches\":%llu,\"mean_batch\":%.2f,\"deduplicated\":%llu,"
+           "\"rejected_unreachable\":%llu,\"states_explored\":%llu,"
+           "\"throughput_qps\":%.1f,"
+           "\"mean_latency_us\":%.1f,\"p50_latency_us\":%llu,"
+           "\"p99_latency_us\":%llu,\"max_latency_us\":%.1f",
+           uptime, requests, counters.errors.load(), batches,
+           batches > 0 ? static_cast<double>(requests) / batches : 0.0,
+           counters.deduplicated.load(), counters.rejected.load(),
+           counters.statesExplored.load(),
+           uptime > 0 ? requests / uptime : 0.0,
+           requests > 0 ? counters.latencyNs / 1000.0 / requests : 0.0,
+           counters.percentileUs(0.5), counters.percentileUs(0.99),
+           counters.maxLatencyNs / 1000.0);
+  return buffer;
+}
+
+/*
+ * Returns true if 'value' is an integer between 'low' and 'high'; false
+ * for NaN and infinities too.
+*/
+static bool isIntegerIn(const double value, const double low,
+                        const double high) {
+  return value >= low && value <= high && value == std::floor(value);
+}
+
+/*
+ * Largest integer that JSON numbers (doubles) represent exactly.
+*/
+static const double kMaxExactInteger = 9007199254740992.0;  // 2^53
+
+/*
+ * Solves one query and formats everything after the "id" field of its
+ * response, closing brace and newline included.
+*/
+static std::string solveQuery(const CompactDirectedGraph& graph,
+                              const ComponentIndex& components,
+                              const HubLabels* labels,
+                              const int start, const int end,
+                              const bool withPath, const SearchBounds& bounds,
+                              const double timeout, Counters* counters) {
+  char buffer[128];
+  if (!components.mayReach(start, end)) {
+    counters->rejected++;
+    snprintf(buffer, sizeof(buffer),
+             ",\"outcome\":0,\"weight\":null,\"states\":0%s}\n",
+             withPath ? ",\"path\":[]" : "");
+    return buffer;
+  }
+
+  if (labels != nullptr && !withPath) {
+    double weight = labels->distance(start, end);
+    if (weight > bounds.maxDistance &&
+        weight < std::numeric_limits<double>::infinity()) {
+      snprintf(buffer, sizeof(buffer),
+               ",\"outcome\":-2,\"weight\":null,\"lower_bound\":%.10g,"
+               "\"best_weight\":%.10g,\"states\":0}\n", weight, weight);
+    } else if (weight < std::numeric_limits<double>::infinity()) {
+      snprintf(buffer, sizeof(buffer),
+               ",\"outcome\":1,\"weight\":%.10g,\"states\":0}\n", weight);
+    } else {
+      snprintf(buffer, sizeof(buffer),
+               ",\"outcome\":0,\"weight\":null,\"states\":0}\n");
+    }
+    return buffer;
+  }
+
+  ComponentView view(graph, components, start, end);
+  BiDijkstraSolver<int, ComponentView> solver(view, start, end, timeout,
+                                              !withPath, bounds);
+  counters->statesExplored += solver.numStatesExplored();
+
+  if (solver.outcome() == 1) {
+    snprintf(buffer, sizeof(buffer),
+             ",\"outcome\":1,\"weight\":%.10g,\"states\":%d",
+             solver.solutionWeight(), solver.numStatesExplored());
+  } else if (solver.outcome() == -2) {
+    // Out of bounds: report what is known of the weight.
+    char best[32] = "null";
+    if (solver.bestWeightFound() < std::numeric_limits<double>::infinity())
+      snprintf(best, sizeof(best), "%.10g", solver.bestWeightFound());
+    snprintf(buffer, sizeof(buffer),
+             ",\"outcome\":-2,\"weight\":null,\"lower_bound\":%.10g,"
+             "\"best_weight\":%s,\"states\":%d", solver.lowerBound(), best,
+             solver.numStatesExplored());
+  } else {
+    snprintf(buffer, sizeof(buffer),
+             ",\"outcome\":%d,\"weight\":null,\"states\":%d",
+             solver.outcome(), solver.numStatesExplored());
+  }
+  std::string body = buffer;
+  if (withPath) {
+    body += ",\"path\":[";
+    const std::vector<int>& path = solver.solution();
+    for (size_t i = 0; i < path.size(); i++) {
+      if (i > 0)
+        body += ',';
+      body += std::to_string(path[i]);
+    }
+    body += ']';
+  }
+  body += "}\n";
+  return body;
+}
+
+/*
+ * Worker loop: takes batches off the queue, answers them and writes the
+ * responses back, one write per connection per batch.
+*/
+static void worker(const CompactDirectedGraph* graph,
+                   const ComponentIndex* components,
+                   const HubLabels* labels, RequestQueue* queue,
+                   Counters* counters, const size_t maxBatch,
+                   const double timeout) {
+  std::vector<Request> batch;
+  // Queries already solved in this batch, keyed by (start, end, path,
+  // max_distance, max_settled).
+  std::map<std::tuple<int, int, bool, double, int>, std::string> solved;
+  std::map<Connection*, std::string> responses;
+
+  while (true) {
+    batch.clear();
+    solved.clear();
+    responses.clear();
+    queue->popBatch(&batch, maxBatch);
+    counters->batches++;
+
+    for (auto& request : batch) {
+      double id = 0, start, end, path = 1, stats = 0;
+      jsonNumber(request.line, "id", &id);
+      if (!isIntegerIn(id, -kMaxExactInteger, kMaxExactInteger)) {
+        counters->errors++;
+        responses[request.connection.get()] +=
+            "{\"id\":null,\"error\":\"bad request\"}\n";
+        continue;
+      }
+      std::string response = "{\"id\":" +
+                             std::to_string(static_cast<long long>(id));
+
+      // Bounds must be finite and non-negative, and 'max_settled' must
+      // fit an int; the comparisons are written to fail for NaN too.
+      double maxDistance = std::numeric_limits<double>::infinity();
+      double maxSettled = 0;
+      bool validBounds =
+          (!jsonNumber(request.line, "max_distance", &maxDistance) ||
+           (maxDistance >= 0 && std::isfinite(maxDistance))) &&
+          (!jsonNumber(request.line, "max_settled", &maxSettled) ||
+           (maxSettled >= 0 && maxSettled <= std::numeric_limits<int>::max()));
+
+      if (jsonNumber(request.line, "stats", &stats) && stats != 0) {
+        response += "," + statsJson(*counters) + "}\n";
+      } else if (!jsonNumber(request.line, "start", &start) ||
+                 !jsonNumber(request.line, "end", &end) ||
+                 !isIntegerIn(start, 0, graph->numVertices() - 1) ||
+                 !isIntegerIn(end, 0, graph->numVertices() - 1) ||
+                 !validBounds) {
+        counters->errors++;
+        response += ",\"error\":\"bad request\"}\n";
+      } else {
+        jsonNumber(request.line, "path", &path);
+        auto key = std::make_tuple(static_cast<int>(start),
+                                   static_cast<int>(end), path != 0,
+                                   maxDistance, static_cast<int>(maxSettled));
+        auto cached = solved.find(key);
+        if (cached != solved.end()) {
+          counters->deduplicated++;
+          response += cached->second;
+        } else {
+          std::string body = solveQuery(*graph, *components, labels,
+                                        std::get<0>(key),
+                                        std::get<1>(key), std::get<2>(key),
+                                        SearchBounds(std::get<3>(key),
+                                                     std::get<4>(key)),
+                                        timeout, counters);
+          solved[key] = body;
+          response += body;
+        }
+      }
+      responses[request.connection.get()] += response;
+    }
+
+    for (auto& out : responses) {
+      std::lock_guard<std::mutex> lock(out.first->writeMutex);
+      writeAll(out.first->fd, out.second.data(), out.second.size());
+    }
+
+    Clock::time_point done = Clock::now();
+    for (auto& request : batch) {
+      counters->requests++;
+      counters->recordLatency(done - request.arrival);
+    }
+  }
+}
+
+/*
+ * Reader loop for one connection: queues every non-empty line. A client
+ * sending a line longer than kMaxLineLength gets an error and is no
+ * longer read from; the connection closes once its pending requests are
+ * answered.
+*/
+static void reader(std::shared_ptr<Connection> connection,
+                   RequestQueue* queue) {
+  LineReader lines(connection->fd);
+  std::string line;
+  while (lines.next(&line)) {
+    if (line.empty())
+      continue;
+    Request request;
+    request.connection = connection;
+    request.line.swap(line);
+    request.arrival = Clock::now();
+    queue->push(std::move(request));
+  }
+  if (lines.tooLong()) {
+    static const char kError[] = "{\"error\":\"line too long\"}\n";
+    std::lock_guard<std::mutex> lock(connection->writeMutex);
+    writeAll(connection->fd, kError, sizeof(kError) - 1);
+    shutdown(connection->fd, SHUT_RD);
+  }
+}
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) { stopRequested = 1; }
+
+int main(int argc, char* argv[]) {
+  std::string graphPath, unixPath, labelsPath, tracePath;
+  int port = -1, randomV = 0, randomE = 0;
+  unsigned randomSeed = 1;
+  int workers = std::thread::hardware_concurrency();
+  int maxBatch = 32;
+  int traceSampling = 1;
+  double timeout = 1.0;
+  bool hugePages = false, numa = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--graph" && i + 1 < argc) {
+      graphPath = argv[++i];
+    } else if (arg == "--random" && i + 3 < argc) {
+      randomV = atoi(argv[++i]);
+      randomE = atoi(argv[++i]);
+      randomSeed = atoi(argv[++i]);
+    } else if (arg == "--unix" && i + 1 < argc) {
+      unixPath = argv[++i];
+    } else if (arg == "--port" && i + 1 < argc) {
+      port = atoi(argv[++i]);
+    } else if (arg == "--workers" && i + 1 < argc) {
+      workers = atoi(argv[++i]);
+    } else if (arg == "--batch" && i + 1 < argc) {
+      maxBatch = atoi(argv[++i]);
+    } else if (arg == "--timeout" && i + 1 < argc) {
+      timeout = atof(argv[++i]);
+    } else if (arg == "--labels" && i + 1 < argc) {
+      labelsPath = argv[++i];
+    } else if (arg == "--huge-pages") {
+      hugePages = true;
+    } else if (arg == "--numa") {
+      numa = true;
+    } else if (arg == "--trace" && i + 1 < argc) {
+      tracePath = argv[++i];
+    } else if (arg == "--trace-sampling" && i + 1 < argc) {
+      traceSampling = atoi(argv[++i]);
+    } else {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return 1;
+    }
+  }
+  if ((graphPath.empty() && randomV <= 0) || (unixPath.empty() && port < 0)) {
+    std::cerr << "Usage: " << argv[0]
+              << " (--graph FILE | --random V E SEED)"
+              << " (--unix PATH | --port N)"
+              << " [--workers N] [--batch N] [--timeout SECONDS]"
+              << " [--labels INDEX_FILE] [--huge-pages] [--numa]"
+              << " [--trace FILE] [--trace-sampling N]" << std::endl;
+    return 1;
+  }
+  if (!tracePath.empty() && !kSearchTraceCompiled) {
+    std::cerr << "--trace needs a build with -DBIDIJKSTRA_TRACE"
+              << " (make query_server_traced)" << std::endl;
+    return 1;
+  }
+  if (workers < 1)
+    workers = 1;
+  if (maxBatch < 1)
+    maxBatch = 1;
+
+  unique_ptr<WeightedDirectedGraph> loaded =
+      graphPath.empty() ? randomGraph(randomV, randomE, randomSeed)
+                        : loadGraph(graphPath);
+  if (!loaded) {
+    std::cerr << "Could not load graph from " << graphPath << std::endl;
+    return 1;
+  }
+  // Queries run on a compact copy; the loaded graph is no longer needed.
+  setHugePageMode(hugePages ? kHugePagesOn : kHugePagesDefault);
+  unique_ptr<CompactDirectedGraph> graph(new CompactDirectedGraph(*loaded));
+  loaded.reset();
+
+  HubLabels labels;
+  if (!labelsPath.empty() && (!labels.load(labelsPath) ||
+                              labels.numVertices() != graph->numVertices())) {
+    std::cerr << "Could not load a hub labeling index for this graph from "
+              << labelsPath << std::endl;
+    return 1;
+  }
+
+  unique_ptr<ComponentIndex> components(
+      new ComponentIndex(*graph, graph->numVertices(), workers));
+  const int V = graph->numVertices();
+
+  // One replica of the graph and component index per NUMA node, each
+  // copied by a thread pinned to that node so that its pages are local.
+  std::vector<NumaNode> nodes(1);
+  std::vector<NumaNode> found = numa ? numaNodes() : std::vector<NumaNode>();
+  std::vector<unique_ptr<CompactDirectedGraph>> graphs;
+  std::vector<unique_ptr<ComponentIndex>> indexes;
+  if (found.size() > 1) {
+    nodes.swap(found);
+    graphs.resize(nodes.size());
+    indexes.resize(nodes.size());
+    std::vector<std::thread> copiers;
+    for (size_t n = 0; n < nodes.size(); n++) {
+      copiers.push_back(std::thread([&, n] {
+        pinToCpus(nodes[n].cpus);
+        graphs[n].reset(new CompactDirectedGraph(*graph));
+        indexes[n].reset(new ComponentIndex(*components));
+      }));
+    }
+    for (auto& copier : copiers)
+      copier.join();
+    graph.reset();
+    components.reset();
+  } else {
+    if (numa)
+      std::cerr << "Single NUMA node; not replicating" << std::endl;
+    graphs.push_back(std::move(graph));
+    indexes.push_back(std::move(components));
+  }
+
+  if (!tracePath.empty()) {
+    SearchTracer::instance().setSampling(traceSampling);
+    SearchTracer::instance().setEnabled(true);
+  }
+
+  int listener = listenOn(unixPath, port);
+  if (listener < 0) {
+    perror("listen");
+    return 1;
+  }
+
+  // No SA_RESTART, so that accept() returns once a signal arrives.
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = onSignal;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+
+  Counters counters;
+  RequestQueue queue;
+  for (int i = 0; i < workers; i++) {
+    size_t n = i % nodes.size();
+    std::vector<int> cpus = nodes.size() > 1 ? nodes[n].cpus
+                                             : std::vector<int>();
+    const CompactDirectedGraph* local = graphs[n].get();
+    const ComponentIndex* localIndex = indexes[n].get();
+    const HubLabels* index = labelsPath.empty() ? nullptr : &labels;
+    std::thread([=, &queue, &counters] {
+      pinToCpus(cpus);  // No-op without cpus.
+      worker(local, localIndex, index, &queue, &counters,
+             static_cast<size_t>(maxBatch), timeout);
+    }).detach();
+  }
+
+  std::cerr << "Serving " << V << " vertices ("
+            << indexes[0]->numComponents() << " components) with "
+            << workers << " workers on " << nodes.size() << " NUMA node(s)"
+            << (hugePages ? ", huge pages advised" : "") << std::endl;
+
+  while (!stopRequested) {
+    int fd = accept(listener, nullptr, nullptr);
+    if (fd < 0) {
+      // Out of file descriptors (EMFILE, ENFILE) or memory: the error
+      // would repeat at once, so back off instead of spinning.
+      if (errno != EINTR && errno != ECONNABORTED)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      continue;
+    }
+    std::thread(reader, std::make_shared<Connection>(fd), &queue).detach();
+  }
+
+  std::cerr << "{" << statsJson(counters) << "}" << std::endl;
+  if (!tracePath.empty()) {
+    SearchTracer& tracer = SearchTracer::instance();
+    tracer.setEnabled(false);
+    bool json = tracePath.size() >= 5 &&
+                tracePath.compare(tracePath.size() - 5, 5, ".json") == 0;
+    if (json ? tracer.writeChromeTrace(tracePath)
+             : tracer.writeBinaryTrace(tracePath))
+      std::cerr << "Trace written to " << tracePath << std::endl;
+    else
+      perror(tracePath.c_str());
+  }
+  if (!unixPath.empty())
+    unlink(unixPath.c_str());
+  // Workers never return; skip destructors of state they still use.
+  _exit(0);
+}
@@ -0,0 +1,188 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <algorithm>
+#include <utility>  // For pair
+#include <limits>  // For numeric_limits
+#include <chrono>  // For high_resolution_clock and duration
+#include "AlternativeRouteSolver.h"
+#include "../trace/SearchTrace.h"
+
+template <typename Vertex, typename GraphType>
+AlternativeRouteSolver<Vertex, GraphType>::AlternativeRouteSolver(
+                const GraphType& input,
+                Vertex start, Vertex end,
+                const int maxAlternatives,
+                const double& timeout,
+                const double maxStretch,
+                const double maxSharing,
+                const double localOptimality) {
+  auto start_time = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed;
+
+  // Initially, assume that problem is 'unsolvable'.
+  outcome_ = 0;
+  numStatesExplored_ = 0;
+  double shortest = std::numeric_limits<double>::infinity();
+  TRACE_QUERY(&outcome_, &shortest, &numStatesExplored_);
+
+  // The shortest path, then every via vertex of an admissible
+  // alternative settled in both of the solver's trees.
+  BiDijkstraSolver<Vertex, GraphType> search(input, start, end, timeout);
+  numStatesExplored_ = search.numStatesExplored();
+  if (search.outcome() != 1) {
+    outcome_ = search.outcome();
+    timeSpent = search.explorationTime();
+    return;
+  }
+  double mu = search.solutionWeight();
+  shortest = mu;
+  bool explored = search.exploreBeyond(input, maxStretch,
+                                       timeout - search.explorationTime());
+  numStatesExplored_ = search.numStatesExplored();
+  elapsed = std::chrono::high_resolution_clock::now() - start_time;
+  if (!explored && elapsed.count() > timeout) {
+    outcome_ = -1;  // Update 'outcome_' to -1 for 'timed-out'.
+    timeSpent = elapsed.count();
+    return;
+  }
+  outcome_ = 1;
+
+  // The shortest path always comes first.
+  std::vector<Vertex> route = search.solution();
+  std::vector<double> cumulative;
+  std::set<std::pair<Vertex, Vertex>> acceptedEdges;
+  std::set<std::vector<Vertex>> accepted;
+  for (size_t i = 0; i + 1 < route.size(); i++)
+    acceptedEdges.insert(std::make_pair(route[i], route[i + 1]));
+  routes_.push_back(route);
+  routeWeights_.push_back(mu);
+  accepted.insert(route);
+
+  // Collect the via vertex candidates, shortest resulting route first.
+  double bound = (1 + maxStretch) * mu;
+  const std::map<Vertex, double>& backwardDistTo = search.backwardDistances();
+  std::vector<std::pair<double, Vertex>> candidates;
+  for (auto& f : search.forwardDistances()) {
+    auto b = backwardDistTo.find(f.first);
+    if (b == backwardDistTo.end() || !search.isSettled(true, f.first) ||
+        !search.isSettled(false, f.first))
+      continue;
+    double weight = f.second + b->second;
+    if (weight <= bound)
+      candidates.push_back(std::make_pair(weight, f.first));
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  for (auto& candidate : candidates) {
+    if (static_cast<int>(routes_.size()) > maxAlternatives)
+      break;
+
+    // Cheapest filters first: the route must be simple and new...
+    if (!buildRoute(&search, candidate.second, start, end, &route,
+                    &cumulative) || accepted.count(route) > 0)
+      continue;
+
+    // ...must not share too much with the routes accepted so far...
+    double shared = 0.0;
+    for (size_t i = 0; i + 1 < route.size(); i++) {
+      if (acceptedEdges.count(std::make_pair(route[i], route[i + 1])) > 0)
+        shared += cumulative[i + 1] - cumulative[i];
+    }
+    if (shared > maxSharing * mu)
+      continue;
+
+    // ...and must be locally optimal around its via vertex.
+    int via = std::find(route.begin(), route.end(), candidate.second) -
+              route.begin();
+    elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (!passesTTest(input, route, cumulative, via, localOptimality * mu,
+                     timeout - elapsed.count()))
+      continue;
+
+    for (size_t i = 0; i + 1 < route.size(); i++)
+      acceptedEdges.insert(std::make_pair(route[i], route[i + 1]));
+    routes_.push_back(route);
+    routeWeights_.push_back(candidate.first);
+    accepted.insert(route);
+  }
+
+  // Extract and record total time.
+  elapsed = std::chrono::high_resolution_clock::now() - start_time;
+  timeSpent = elapsed.count();
+}
+
+template <typename Vertex, typename GraphType>
+bool AlternativeRouteSolver<Vertex, GraphType>::buildRoute(
+                                BiDijkstraSolver<Vertex, GraphType>* search,
+                                const Vertex& via,
+                                Vertex start, Vertex end,
+                                std::vector<Vertex>* route,
+                                std::vector<double>* cumulative) {
+  const std::map<Vertex, Vertex>& forwardEdgeTo = search->forwardTree();
+  const std::map<Vertex, Vertex>& backwardEdgeTo = search->backwardTree();
+  const std::map<Vertex, double>& forwardDistTo = search->forwardDistances();
+  const std::map<Vertex, double>& backwardDistTo =
+                                  search->backwardDistances();
+  route->clear();
+  cumulative->clear();
+
+  /* -- Forward tree's vertices (including 'via' vertex). -- */
+  Vertex trace = via;
+  route->push_back(trace);
+  while (trace != start) {
+    trace = forwardEdgeTo.find(trace)->second;
+    route->push_back(trace);
+  }
+  std::reverse(route->begin(), route->end());
+  for (auto& v : *route)
+    cumulative->push_back(forwardDistTo.find(v)->second);
+
+  /* -- Backward tree's vertices (excluding 'via' vertex). -- */
+  double total = cumulative->back() + backwardDistTo.find(via)->second;
+  trace = via;
+  while (trace != end) {
+    trace = backwardEdgeTo.find(trace)->second;
+    route->push_back(trace);
+    cumulative->push_back(total - backwardDistTo.find(trace)->second);
+  }
+
+  // The two halves may cross each other; such a route is not simple.
+  std::set<Vertex> seen(route->begin(), route->end());
+  return seen.size() == route->size();
+}
+
+template <typename Vertex, typename GraphType>
+bool AlternativeRouteSolver<Vertex, GraphType>::passesTTest(
+                                      const GraphType& input,
+                                      const std::vector<Vertex>& route,
+                                      const std::vector<double>& cumulative,
+                                      const int via, const double window,
+                                      const double& timeout) {
+  // Walk outwards from the via vertex until 'window' weight is covered on
+  // each side (or the route ends).
+  int x = via;
+  while (x > 0 && cumulative[via] - cumulative[x] < window)
+    x--;
+  int y = via;
+  int last = route.size() - 1;
+  while (y < last && cumulative[y] - cumulative[via] < window)
+    y++;
+
+  double subWeight = cumulative[y] - cumulative[x];
+  double tolerance = 1e-9 * std::max(1.0, subWeight);
+
+  // The subpath fails if some path from route[x] to route[y] is shorter,
+  // which a search bounded to that weight settles without going further.
+  BiDijkstraSolver<Vertex, GraphType> check(input, route[x], route[y],
+                                            timeout, true,
+                                            SearchBounds(subWeight -
+                                                         tolerance));
+  numStatesExplored_ += check.numStatesExplored();
+  if (check.outcome() == 1)
+    return check.solutionWeight() >= subWeight - tolerance;
+  return check.outcome() != -1;
+}
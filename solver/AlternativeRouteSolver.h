@@ -0,0 +1,135 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef ALTERNATIVEROUTESOLVER_H_
+#define ALTERNATIVEROUTESOLVER_H_
+
+#include <map>
+#include <set>
+#include <vector>
+#include "../graph/Graph.h"
+#include "../graph/StaticGraph.h"
+#include "BiDijkstraSolver.h"
+
+/*
+ * Class for finding alternative routes between two vertices using the
+ * "via-vertex" approach.
+ *
+ * The solver runs a BiDijkstraSolver, then lets its forward and backward
+ * searches settle vertices past the meeting point until neither tree can
+ * contribute to a route within the allowed stretch (see
+ * BiDijkstraSolver::exploreBeyond()). Every vertex settled in both
+ * directions is a candidate via vertex 'v', and the route
+ * start => v => end is read directly off the solver's two trees; no
+ * additional shortest-path searches are needed apart from the small
+ * local optimality checks, which are bounded BiDijkstraSolver queries.
+ *
+ * Like BiDijkstraSolver, the solving is performed in the constructor.
+*/
+template <typename Vertex, typename GraphType = Graph<Vertex>>
+class AlternativeRouteSolver {
+  static_assert(IsStaticGraph<GraphType, Vertex>::value,
+                "See graph/StaticGraph.h for requirements on GraphType.");
+
+ public:
+  /*
+   * Ctor. Arguments:
+   *
+   * - input, start, end, timeout: Same as for BiDijkstraSolver.
+   *
+   * - maxAlternatives: Maximum number of routes returned in addition
+   * to the shortest one.
+   *
+   * - maxStretch: An alternative may be at most (1 + maxStretch) times
+   * as long as the shortest path.
+   *
+   * - maxSharing: An alternative may share at most (maxSharing * weight
+   * of the shortest path) with the routes accepted before it.
+   *
+   * - localOptimality: Every subpath of an alternative around its via
+   * vertex of weight up to (localOptimality * weight of the shortest
+   * path) must itself be a shortest path (the "T-test").
+  */
+  AlternativeRouteSolver(const GraphType& input, Vertex start,
+                         Vertex end, const int maxAlternatives,
+                         const double& timeout,
+                         const double maxStretch = 0.25,
+                         const double maxSharing = 0.8,
+                         const double localOptimality = 0.25);
+
+  /*
+   * Dtor.
+  */
+  ~AlternativeRouteSolver() { }
+
+  /*
+   * Returns 1 for 'solved', 0 for 'unsolvable', -1 for 'timed-out'.
+  */
+  int outcome() { return outcome_; }
+
+  /*
+   * The number of routes found, including the shortest one.
+   * Returns 0 if problem was unsolvable or solving timed out.
+  */
+  int numRoutes() { return routes_.size(); }
+
+  /*
+   * A vector of vertices corresponding to the i-th route, from start to
+   * end. Route 0 is the shortest path; the rest are ordered by weight.
+  */
+  const std::vector<Vertex>& route(const int i) { return routes_[i]; }
+
+  /*
+   * The total weight of the i-th route.
+  */
+  double routeWeight(const int i) { return routeWeights_[i]; }
+
+  /*
+   * The total number of states explored while solving, including those
+   * explored by the local optimality checks.
+  */
+  int numStatesExplored() { return numStatesExplored_; }
+
+  /*
+   * The total time spent in seconds by the constructor.
+  */
+  double explorationTime() { return timeSpent; }
+
+ private:
+  /*
+   * Results.
+  */
+  int outcome_;
+  std::vector<std::vector<Vertex>> routes_;
+  std::vector<double> routeWeights_;
+  int numStatesExplored_;
+  double timeSpent;
+
+  /*
+   * Builds the route start => via => end out of the two search trees of
+   * 'search'. 'cumulative' receives the weight from start to each vertex
+   * on the route. Returns false if the route is not a simple path.
+  */
+  static bool buildRoute(BiDijkstraSolver<Vertex, GraphType>* search,
+                         const Vertex& via, Vertex start, Vertex end,
+                         std::vector<Vertex>* route,
+                         std::vector<double>* cumulative);
+
+  /*
+   * Returns true if the subpath of 'route' around index 'via' that spans
+   * at least 'window' weight in each direction is a shortest path, false
+   * if it is not or that could not be checked within 'timeout' seconds.
+  */
+  bool passesTTest(const GraphType& input,
+                   const std::vector<Vertex>& route,
+                   const std::vector<double>& cumulative,
+                   const int via, const double window,
+                   const double& timeout);
+};
+
+#include "AlternativeRouteSolver.cpp"
+
+#endif  // ALTERNATIVEROUTESOLVER_H_
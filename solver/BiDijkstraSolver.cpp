@@ -4,17 +4,36 @@
  * Copyright 2020 Dat Do
 */
 
-#include <algorithm>
-#include <unordered_set>
+#include <algorithm>  // For copy and reverse
+#include <cmath>  // For isfinite
+#include <iterator>  // For advance
 #include <limits>  // For numeric_limits
 #include <chrono>  // For high_resolution_clock and duration
 #include "BiDijkstraSolver.h"
 
+/*
+ * Helper functions for A* potentials: only vertices of type 'int' have
+ * coordinates.
+*/
 template <typename Vertex>
-BiDijkstraSolver<Vertex>::BiDijkstraSolver(
-                const Graph<Vertex>& input,
+static double coordinateDistance(const Coordinates& coordinates,
+                                 const Vertex& u, const Vertex& v) {
+  return 0.0;
+}
+static inline double coordinateDistance(const Coordinates& coordinates,
+                                        const int& u, const int& v) {
+  return coordinates.distance(u, v);
+}
+
+template <typename Vertex, typename GraphType>
+BiDijkstraSolver<Vertex, GraphType>::BiDijkstraSolver(
+                const GraphType& input,
                 Vertex start, Vertex end,
-                const double& timeout) {
+                const double& timeout, const bool distanceOnly,
+                const SearchBounds& bounds) :
+                coordinates_(nullptr), maxSpeed_(0), bounds_(bounds),
+                pruned(false), distanceOnly_(distanceOnly),
+                materialized(false), solutionSize_(-1) {
   auto start_time = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed;
 
@@ -23,9 +42,18 @@ BiDijkstraSolver<Vertex>::BiDijkstraSolver(
   // == operator to check for equality.
   if (start == end) {
     outcome_ = 1;
-    solution_.push_back(start);
+    mid_ = start;
+    if (!distanceOnly) {
+      forwardEdgeTo[start] = start;
+      backwardEdgeTo[start] = start;
+    }
     solutionWeight_ = 0;
+    lowerBound_ = 0;
+    bestWeightFound_ = 0;
     numStatesExplored_ = 1;
+    TRACE_QUERY(&outcome_, &solutionWeight_, &numStatesExplored_);
+    TRACE_SETTLE(true, start, 0.0, 0);
+    TRACE_MEET(start, 0.0);
 
     auto finish1 = std::chrono::high_resolution_clock::now();
     elapsed = finish1 - start_time;
@@ -33,155 +61,417 @@ BiDijkstraSolver<Vertex>::BiDijkstraSolver(
     return;
   }
 
-  std::unordered_set<Vertex> visited;
+  solve(input, std::vector<std::pair<Vertex, double>>(1, {start, 0.0}),
+        std::vector<std::pair<Vertex, double>>(1, {end, 0.0}),
+        timeout, 0, start_time);
+}
+
+template <typename Vertex, typename GraphType>
+BiDijkstraSolver<Vertex, GraphType>::BiDijkstraSolver(
+                const GraphType& input,
+                Vertex start, Vertex end,
+                const double& timeout,
+                const Coordinates& coordinates, const double maxSpeed,
+                const bool distanceOnly, const SearchBounds& bounds) :
+                coordinates_(&coordinates), maxSpeed_(maxSpeed),
+                start_(start), end_(end), bounds_(bounds), pruned(false),
+                distanceOnly_(distanceOnly), materialized(false),
+                solutionSize_(-1) {
+  // Without a usable speed bound (e.g. no edge has a positive length) or
+  // with coordinates for another graph, the potentials would be NaN or
+  // read out of bounds; fall back to zero potentials instead.
+  if (!std::isfinite(maxSpeed) || maxSpeed <= 0 ||
+      coordinates.size() != input.numVertices())
+    coordinates_ = nullptr;
+  solve(input, std::vector<std::pair<Vertex, double>>(1, {start, 0.0}),
+        std::vector<std::pair<Vertex, double>>(1, {end, 0.0}),
+        timeout, 0, std::chrono::high_resolution_clock::now());
+}
+
+template <typename Vertex, typename GraphType>
+BiDijkstraSolver<Vertex, GraphType>::BiDijkstraSolver(
+                const GraphType& input,
+                const std::vector<std::pair<Vertex, double>>& starts,
+                const std::vector<std::pair<Vertex, double>>& ends,
+                const double& timeout, const int kNearest,
+                const bool distanceOnly) :
+                coordinates_(nullptr), maxSpeed_(0), pruned(false),
+                distanceOnly_(distanceOnly), materialized(false),
+                solutionSize_(-1) {
+  solve(input, starts, ends, timeout, kNearest,
+        std::chrono::high_resolution_clock::now());
+}
+
+template <typename Vertex, typename GraphType>
+void BiDijkstraSolver<Vertex, GraphType>::solve(
+                const GraphType& input,
+                const std::vector<std::pair<Vertex, double>>& starts,
+                const std::vector<std::pair<Vertex, double>>& ends,
+                const double& timeout, const int kNearest,
+                std::chrono::high_resolution_clock::time_point start_time) {
+  std::chrono::duration<double> elapsed;
 
   // Initially, assume that problem is 'unsolvable'.
   outcome_ = 0;
   solutionWeight_ = std::numeric_limits<double>::infinity();
+  lowerBound_ = 0;
+  bestWeightFound_ = std::numeric_limits<double>::infinity();
+  nearestEndsComplete_ = false;
   numStatesExplored_ = 0;
+  TRACE_QUERY(&outcome_, &solutionWeight_, &numStatesExplored_);
 
-  // Add start vertex to the forward-fringe/edgeTo/DistTo data structures.
-  forwardFringe.add(start, 0.0);
-  forwardEdgeTo[start] = start;
-  forwardDistTo[start] = 0.0;
+  // Add start vertices to the forward-fringe/edgeTo/DistTo data structures.
+  // A vertex that maps to itself in 'forwardEdgeTo' is a start.
+  for (auto& s : starts) {
+    double priority = s.second + potential(true, s.first);
+    if (forwardDistTo.find(s.first) == forwardDistTo.end()) {
+      forwardFringe.add(s.first, priority);
+    } else if (s.second < forwardDistTo[s.first]) {
+      forwardFringe.changePriority(s.first, priority);
+    } else {
+      continue;
+    }
+    if (!distanceOnly_)
+      forwardEdgeTo[s.first] = s.first;
+    forwardDistTo[s.first] = s.second;
+  }
 
-  // Add end vertex to the backward-fringe/edgeTo/DistTo data structures.
-  backwardFringe.add(end, 0.0);
-  backwardEdgeTo[end] = end;
-  backwardDistTo[end] = 0.0;
+  // Add end vertices to the backward-fringe/edgeTo/DistTo data structures.
+  for (auto& e : ends) {
+    double priority = e.second + potential(false, e.first);
+    if (backwardDistTo.find(e.first) == backwardDistTo.end()) {
+      backwardFringe.add(e.first, priority);
+    } else if (e.second < backwardDistTo[e.first]) {
+      backwardFringe.changePriority(e.first, priority);
+    } else {
+      continue;
+    }
+    if (!distanceOnly_)
+      backwardEdgeTo[e.first] = e.first;
+    backwardDistTo[e.first] = e.second;
+    if (kNearest > 0)
+      endOffsets[e.first] = e.second;
+  }
 
-  Vertex mid;  // Vertex where both path meets.
-  double prevDist;  // Distance to the vertex being removed from the fringe.
-  double dist;  // Distance to the vertex being relaxed.
-  double totalTimeSoFar;
+  // 'mu' is the weight of the best path seen so far, through 'mid'.
+  // A vertex that is both a start and an end is already such a path.
+  double mu = std::numeric_limits<double>::infinity();
+  Vertex mid;
+  for (auto& s : forwardDistTo) {
+    auto e = backwardDistTo.find(s.first);
+    if (e != backwardDistTo.end() && s.second + e->second < mu) {
+      mu = s.second + e->second;
+      mid = s.first;
+    }
+  }
 
-  // Both fringe must be non-empty while examining/relaxing each vertex.
+  // Alternate between the two directions while both fringes are non-empty.
+  bool forward = true;
+  int numSettled[2] = {0, 0};  // Backward, forward.
   while (!forwardFringe.isEmpty() && !backwardFringe.isEmpty()) {
-    /* -------------------- Forward path. -------------------- */
-    // Once removed from fringe. Shortest path to this vertex is established.
-    Vertex* a = forwardFringe.removeSmallest();
-    numStatesExplored_++;
-
-    // Check if this vertex has already been visited in the other direction.
-    if (visited.insert(*a).second == false) {
-      mid = *a;  // Initialize 'mid'.
-      outcome_ = 1;  // Update 'outcome_' to 1 for 'solved'.
-      delete a;
+    /*
+     * Every path not seen yet is at least as long as the sum of the
+     * smallest priorities left in the two fringes. Once that reaches 'mu',
+     * the path through 'mid' is a shortest path. (With A* potentials,
+     * which sum to 0 at every vertex, this is the same rule applied to
+     * reduced edge weights.)
+    */
+    const Vertex& nextForward = *forwardFringe.getSmallest();
+    const Vertex& nextBackward = *backwardFringe.getSmallest();
+    lowerBound_ = forwardDistTo[nextForward] + potential(true, nextForward) +
+                  backwardDistTo[nextBackward] + potential(false, nextBackward);
+    if (lowerBound_ >= mu)
       break;
-    }
 
-    prevDist = forwardDistTo[*a];
-    // Relax the removed vertex's neighbors.
-    for (auto& edge : input.outgoingNeighbors(*a)) {
-      Vertex b = (*edge).to();
-      dist = prevDist + (*edge).weight();
-      if (forwardDistTo.find(b) == forwardDistTo.end()) {
-        // First time seeing this vertex; simply add to data structures.
-        forwardFringe.add(b, dist);
-        forwardEdgeTo[b] = *a;
-        forwardDistTo[b] = dist;
-      } else {
-        /* 
-         * Seen this vertex before. Only update its distance/edgeTo
-         * if new 'dist' is smaller than existing distance.
-         * 
-         * Possibly, this vertex could be one that has already
-         * been removed from the fringe. But since the shortest path
-         * to it has already been established (invariant of Dijkstra's
-         * once a vertex is removed), there would be no updates.
-        */
-        if (dist < forwardDistTo[b]) {
-          forwardFringe.changePriority(b, dist);
-          forwardEdgeTo[b] = *a;
-          forwardDistTo[b] = dist;
-        }
-      }
+    // Give up once no path within the bounds can be left to find.
+    if (lowerBound_ > bounds_.maxDistance || (bounds_.maxSettled > 0 &&
+        numSettled[forward] >= bounds_.maxSettled)) {
+      outcome_ = -2;  // Update 'outcome_' to -2 for 'out of bounds'.
+      bestWeightFound_ = mu;
+      elapsed = std::chrono::high_resolution_clock::now() - start_time;
+      timeSpent = elapsed.count();
+      return;
     }
 
-    /* -------------------- Backward path. -------------------- */
-    // Once removed from fringe. Shortest path to this vertex is established.
-    Vertex* v = backwardFringe.removeSmallest();
-    numStatesExplored_++;
+    settleNext(input, forward, &mu, &mid);
+    numSettled[forward]++;
+    forward = !forward;
 
-    // Check if this vertex has already been visited in the other direction.
-    if (visited.insert(*v).second == false) {
-      mid = *v;  // Initialize 'mid'.
-      outcome_ = 1;  // Update 'outcome_' to 1 for 'solved'.
-      delete a;
-      delete v;
-      break;
+    // Check if algorithm's taking longer than specified.
+    elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (elapsed.count() > timeout) {
+      TRACE_TIMEOUT(numStatesExplored_);
+      outcome_ = -1;  // Update 'outcome_' to -1 for 'timed-out'.
+      bestWeightFound_ = mu;
+      timeSpent = elapsed.count();  // Record time.
+      return;
     }
+  }
+
+  // Path was found; record where the searches met and update
+  // 'solutionWeight_'. The path itself is only traced on demand.
+  // Paths through vertices left out for being too far were not seen, but
+  // any such path is heavier than 'bounds_.maxDistance'. A path found
+  // heavier than that is out of bounds too, even if nothing was left out
+  // (both searches may stay within the bounds yet meet beyond them).
+  if (mu < std::numeric_limits<double>::infinity() &&
+      mu <= bounds_.maxDistance) {
+    outcome_ = 1;
+    mid_ = mid;
+    solutionWeight_ = mu;
+    lowerBound_ = mu;
+    bestWeightFound_ = mu;
+  } else if (pruned || mu < std::numeric_limits<double>::infinity()) {
+    outcome_ = -2;  // No path within 'bounds_.maxDistance'.
+    lowerBound_ = bounds_.maxDistance;
+    bestWeightFound_ = mu;
+  } else {
+    lowerBound_ = std::numeric_limits<double>::infinity();
+  }
+
+  /*
+   * Continue the forward search until the 'kNearest' closest ends are
+   * known, i.e. until the k-th closest end settled so far is no further
+   * than the smallest distance left in the forward fringe.
+  */
+  if (kNearest > 0 && outcome_ == 1) {
+    nearestEndsComplete_ = true;
+    while (!forwardFringe.isEmpty()) {
+      if (static_cast<int>(settledEnds.size()) >= kNearest) {
+        auto kth = settledEnds.begin();
+        std::advance(kth, kNearest - 1);
+        if (kth->first <= forwardDistTo[*forwardFringe.getSmallest()])
+          break;
+      }
+      settleNext(input, true, &mu, &mid);
 
-    prevDist = backwardDistTo[*v];
-    // Relax the removed vertex's neighbors.
-    for (auto& edge : input.incomingNeighbors(*v)) {
-      Vertex w = (*edge).to();
-      dist = prevDist + (*edge).weight();
-      if (backwardDistTo.find(w) == backwardDistTo.end()) {
-        // First time seeing this vertex; simply add to data structures.
-        backwardFringe.add(w, dist);
-        backwardEdgeTo[w] = *v;
-        backwardDistTo[w] = dist;
-      } else {
-        /* 
-         * Seen this vertex before. Only update its distance/edgeTo
-         * if new 'dist' is smaller than existing distance.
-         * 
-         * Possibly, this vertex could be one that has already
-         * been removed from the fringe. But since the shortest path
-         * to it has already been established (invariant of Dijkstra's
-         * once a vertex is removed), there would be no updates.
-        */
-        if (dist < backwardDistTo[w]) {
-          backwardFringe.changePriority(w, dist);
-          backwardEdgeTo[w] = *v;
-          backwardDistTo[w] = dist;
-        }
+      elapsed = std::chrono::high_resolution_clock::now() - start_time;
+      if (elapsed.count() > timeout) {
+        // Keep the solution; only the nearest ends are cut short.
+        nearestEndsComplete_ = false;
+        break;
       }
     }
 
-    // Clean up.
-    delete a;
-    delete v;
+    for (auto& e : settledEnds) {
+      if (static_cast<int>(nearestEnds_.size()) == kNearest)
+        break;
+      nearestEnds_.push_back(std::make_pair(e.second, e.first));
+    }
+  }
+
+  // Extract and record total time.
+  elapsed = std::chrono::high_resolution_clock::now() - start_time;
+  timeSpent = elapsed.count();
+}
+
+template <typename Vertex, typename GraphType>
+bool BiDijkstraSolver<Vertex, GraphType>::exploreBeyond(
+                const GraphType& input, const double stretch,
+                const double& timeout) {
+  if (outcome_ != 1 || coordinates_ != nullptr)
+    return false;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed;
+  TRACE_QUERY(&outcome_, &solutionWeight_, &numStatesExplored_);
+
+  // 'mu' cannot improve any more; the copies only serve settleNext().
+  double bound = (1 + stretch) * solutionWeight_;
+  double mu = solutionWeight_;
+  Vertex mid = mid_;
+  while (true) {
+    bool forwardDone = forwardFringe.isEmpty() ||
+                forwardDistTo[*forwardFringe.getSmallest()] > bound;
+    bool backwardDone = backwardFringe.isEmpty() ||
+                backwardDistTo[*backwardFringe.getSmallest()] > bound;
+    if (forwardDone && backwardDone)
+      return true;
+
+    if (!forwardDone)
+      settleNext(input, true, &mu, &mid);
+    if (!backwardDone)
+      settleNext(input, false, &mu, &mid);
 
-    // Extract total time so far.
-    auto finish2 = std::chrono::high_resolution_clock::now();
-    elapsed = finish2 - start_time;
-    totalTimeSoFar = elapsed.count();
     // Check if algorithm's taking longer than specified.
-    if (totalTimeSoFar > timeout) {
-      outcome_ = -1;  // Update 'outcome_' to -1 for 'timed-out'.
-      timeSpent = totalTimeSoFar;  // Record time.
-      return;
+    elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (elapsed.count() > timeout) {
+      TRACE_TIMEOUT(numStatesExplored_);
+      return false;
     }
   }
+}
 
-  // Path was found; populate the 'solution_' vector and update
-  // 'solutionWeight_'.
-  if (outcome_ == 1) {
-    /* -- Forward path's vertices (including 'mid' vertex). -- */
-    solution_.push_back(mid);
-    Vertex trace = forwardEdgeTo[mid];
-    while (trace != start) {
-      solution_.push_back(trace);
-      trace = forwardEdgeTo[trace];
-    }
+template <typename Vertex, typename GraphType>
+bool BiDijkstraSolver<Vertex, GraphType>::isSettled(const bool forward,
+                                                    const Vertex& v) {
+  if (forward)
+    return forwardDistTo.count(v) > 0 && !forwardFringe.contains(v);
+  return backwardDistTo.count(v) > 0 && !backwardFringe.contains(v);
+}
+
+template <typename Vertex, typename GraphType>
+const std::vector<Vertex>& BiDijkstraSolver<Vertex, GraphType>::solution() {
+  if (!materialized) {
+    materialized = true;
+    if (outcome_ != 1 || distanceOnly_)
+      return solution_;
+
+    /* -- Forward path's vertices (including 'mid' vertex), backwards. -- */
+    Vertex trace = mid_;
     solution_.push_back(trace);
+    for (Vertex prev = forwardEdgeTo.find(trace)->second; prev != trace;
+         prev = forwardEdgeTo.find(trace)->second) {
+      solution_.push_back(prev);
+      trace = prev;
+    }
     std::reverse(solution_.begin(), solution_.end());
 
     /* -- Backward path's vertices (excluding 'mid' vertex). -- */
-    trace = backwardEdgeTo[mid];
-    while (trace != end) {
-      solution_.push_back(trace);
-      trace = backwardEdgeTo[trace];
+    trace = mid_;
+    for (Vertex next = backwardEdgeTo.find(trace)->second; next != trace;
+         next = backwardEdgeTo.find(trace)->second) {
+      solution_.push_back(next);
+      trace = next;
     }
-    solution_.push_back(trace);
+    solutionSize_ = solution_.size();
+  }
+  return solution_;
+}
+
+template <typename Vertex, typename GraphType>
+int BiDijkstraSolver<Vertex, GraphType>::solutionSize() {
+  if (solutionSize_ < 0)
+    copySolution(nullptr, nullptr, 0);
+  return solutionSize_;
+}
 
-    solutionWeight_ = forwardDistTo[mid] + backwardDistTo[mid];
+template <typename Vertex, typename GraphType>
+int BiDijkstraSolver<Vertex, GraphType>::copySolution(Vertex* vertices,
+                                                      double* weights,
+                                                      const int capacity) {
+  if (outcome_ != 1 || distanceOnly_)
+    solutionSize_ = 0;
+  if (solutionSize_ == 0 || solutionSize_ > capacity)
+    return solutionSize_;
+  if (materialized && weights == nullptr) {
+    std::copy(solution_.begin(), solution_.end(), vertices);
+    return solutionSize_;
   }
 
-  // Extract and record total time.
-  auto finish3 = std::chrono::high_resolution_clock::now();
-  elapsed = finish3 - start_time;
-  timeSpent = elapsed.count();
+  // A single walk down each tree, writing while the buffers have room.
+  /* -- Forward path's vertices (including 'mid' vertex), backwards. -- */
+  int length = 1;
+  Vertex trace = mid_;
+  if (capacity > 0)
+    vertices[0] = trace;
+  for (Vertex prev = forwardEdgeTo.find(trace)->second; prev != trace;
+       prev = forwardEdgeTo.find(trace)->second) {
+    if (length < capacity) {
+      vertices[length] = prev;
+      if (weights != nullptr)
+        weights[length - 1] = forwardDistTo[trace] - forwardDistTo[prev];
+    }
+    length++;
+    trace = prev;
+  }
+  if (length <= capacity) {
+    std::reverse(vertices, vertices + length);
+    if (weights != nullptr)
+      std::reverse(weights, weights + length - 1);
+  }
+
+  /* -- Backward path's vertices (excluding 'mid' vertex). -- */
+  int i = length - 1;
+  trace = mid_;
+  for (Vertex next = backwardEdgeTo.find(trace)->second; next != trace;
+       next = backwardEdgeTo.find(trace)->second) {
+    if (i + 1 < capacity) {
+      if (weights != nullptr)
+        weights[i] = backwardDistTo[trace] - backwardDistTo[next];
+      vertices[i + 1] = next;
+    }
+    i++;
+    trace = next;
+  }
+  solutionSize_ = i + 1;
+  return solutionSize_;
+}
+
+template <typename Vertex, typename GraphType>
+double BiDijkstraSolver<Vertex, GraphType>::potential(const bool forward,
+                                                     const Vertex& v) const {
+  if (coordinates_ == nullptr)
+    return 0.0;
+  double p = (coordinateDistance(*coordinates_, v, end_) -
+              coordinateDistance(*coordinates_, start_, v)) / (2 * maxSpeed_);
+  return forward ? p : -p;
+}
+
+template <typename Vertex, typename GraphType>
+void BiDijkstraSolver<Vertex, GraphType>::settleNext(
+                                      const GraphType& input,
+                                      const bool forward,
+                                      double* mu, Vertex* mid) {
+  ExtrinsicMinPQ<Vertex>& fringe = forward ? forwardFringe : backwardFringe;
+  std::map<Vertex, Vertex>& edgeTo = forward ? forwardEdgeTo : backwardEdgeTo;
+  std::map<Vertex, double>& distTo = forward ? forwardDistTo : backwardDistTo;
+  std::map<Vertex, double>& otherDistTo =
+                          forward ? backwardDistTo : forwardDistTo;
+
+  // Once removed from fringe. Shortest path to this vertex is established.
+  Vertex* a = fringe.removeSmallest();
+  numStatesExplored_++;
+
+  double prevDist = distTo[*a];
+  TRACE_SETTLE(forward, *a, prevDist, fringe.size());
+  if (forward && !endOffsets.empty()) {
+    auto offset = endOffsets.find(*a);
+    if (offset != endOffsets.end())
+      settledEnds.insert(std::make_pair(prevDist + offset->second, *a));
+  }
+
+  // Relax the removed vertex's neighbors.
+  auto&& edges =
+      forward ? input.outgoingNeighbors(*a) : input.incomingNeighbors(*a);
+  for (auto& edge : edges) {
+    Vertex b = edgeTarget(edge);
+    double dist = prevDist + edgeWeight(edge);
+    if (dist > bounds_.maxDistance) {
+      // Too far to be on any path within the bounds.
+      pruned = true;
+      continue;
+    }
+    if (distTo.find(b) == distTo.end()) {
+      // First time seeing this vertex; simply add to data structures.
+      fringe.add(b, dist + potential(forward, b));
+      if (!distanceOnly_)
+        edgeTo[b] = *a;
+      distTo[b] = dist;
+    } else if (dist < distTo[b]) {
+      /*
+       * Seen this vertex before. Only update its distance/edgeTo
+       * if new 'dist' is smaller than existing distance.
+       *
+       * Possibly, this vertex could be one that has already
+       * been removed from the fringe. But since the shortest path
+       * to it has already been established (invariant of Dijkstra's
+       * once a vertex is removed), there would be no updates.
+      */
+      fringe.changePriority(b, dist + potential(forward, b));
+      if (!distanceOnly_)
+        edgeTo[b] = *a;
+      distTo[b] = dist;
+    }
+
+    // Both directions reached this vertex; check the path through it.
+    auto other = otherDistTo.find(b);
+    if (other != otherDistTo.end() && distTo[b] + other->second < *mu) {
+      *mu = distTo[b] + other->second;
+      *mid = b;
+      TRACE_MEET(b, *mu);
+    }
+  }
+
+  // Clean up.
+  delete a;
 }
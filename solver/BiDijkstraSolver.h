@@ -7,29 +7,118 @@
 #ifndef BIDIJKSTRASOLVER_H_
 #define BIDIJKSTRASOLVER_H_
 
+#include <assert.h>
+#include <chrono>  // For high_resolution_clock
+#include <limits>  // For numeric_limits
 #include <map>
+#include <set>
+#include <utility>  // For pair
 #include <vector>
+#include "../graph/Coordinates.h"
 #include "../graph/Graph.h"
+#include "../graph/StaticGraph.h"
 #include "../pq/ExtrinsicMinPQ.h"
+#include "../trace/SearchTrace.h"
+
+/*
+ * Limits on how far a point-to-point search may go before it gives up
+ * (see BiDijkstraSolver's ctors), for queries that are expected to be
+ * local.
+*/
+struct SearchBounds {
+  /*
+   * Ctor.
+   * 'maxDistance' is the heaviest path of interest (infinity for no
+   * limit); 'maxSettled' is the most vertices each direction may settle
+   * (0 for no limit).
+  */
+  explicit SearchBounds(
+      const double maxDistance = std::numeric_limits<double>::infinity(),
+      const int maxSettled = 0) :
+      maxDistance(maxDistance), maxSettled(maxSettled) { }
+
+  double maxDistance;
+  int maxSettled;
+};
 
 /*
  * Class for the Bidirectional Dijkstra's Algorithm solver.
  * This class only provides functions for getting results of a
  * shortest path problem, since the solving is performed in the
  * constructor of the class.
+ *
+ * 'GraphType' defaults to the virtual interface 'Graph<Vertex>'. Any graph
+ * meeting the requirements in "graph/StaticGraph.h" can be used instead,
+ * e.g. BiDijkstraSolver<int, CompactDirectedGraph>, which lets adjacency
+ * access be inlined into the search loop.
 */
-template <typename Vertex> class BiDijkstraSolver {
+template <typename Vertex, typename GraphType = Graph<Vertex>>
+class BiDijkstraSolver {
+  static_assert(IsStaticGraph<GraphType, Vertex>::value,
+                "See graph/StaticGraph.h for requirements on GraphType.");
+
  public:
   /*
    * Ctor.
    * Immediately solves and stores the result of running the Bidirectional
    * Dijkstra's Algorithm, computing everything necessary for all other functions
    * to return their results in constant time. The timeout is given in seconds.
-   * 
-   * Read "graph/Graph.h" for further documentation on requirements for 'input'.
+   *
+   * Read "graph/Graph.h" (or "graph/StaticGraph.h") for further documentation
+   * on requirements for 'input'.
+   *
+   * If 'distanceOnly' is true, no predecessors are kept track of: only
+   * outcome(), solutionWeight() and the statistics are available, and the
+   * solution is always empty.
+   *
+   * With 'bounds', the search stops early, with outcome -2, once it is
+   * sure that no path weighs at most 'bounds.maxDistance', or once one
+   * direction has settled 'bounds.maxSettled' vertices without finding a
+   * shortest path. Vertices further than 'bounds.maxDistance' from the
+   * start (or end) are never added to the fringes, so the search's memory
+   * stays proportional to the region within that distance.
+  */
+  BiDijkstraSolver(const GraphType& input, Vertex start,
+                          Vertex end, const double& timeout,
+                          const bool distanceOnly = false,
+                          const SearchBounds& bounds = SearchBounds());
+
+  /*
+   * Ctor for bidirectional A*.
+   * Same as above, but both searches are guided towards each other by
+   * potentials from the vertices' coordinates: with h(u, v) the distance
+   * between u and v divided by 'maxSpeed', the forward potential of v is
+   * (h(v, end) - h(start, v)) / 2 and the backward one its negation.
+   * Averaging keeps both consistent, so the result is still exact, as
+   * long as no edge weighs less than its length divided by 'maxSpeed'
+   * (see Coordinates::maxSpeed()). Only for vertices of type 'int', and
+   * 'input' must also provide numVertices(). If 'maxSpeed' is not finite
+   * and positive, or 'coordinates' does not hold one position per vertex,
+   * the potentials are all zero: plain Bidirectional Dijkstra's.
+  */
+  BiDijkstraSolver(const GraphType& input, Vertex start,
+                   Vertex end, const double& timeout,
+                   const Coordinates& coordinates, const double maxSpeed,
+                   const bool distanceOnly = false,
+                   const SearchBounds& bounds = SearchBounds());
+
+  /*
+   * Ctor for multi-source/multi-target problems.
+   * Every (vertex, offset) pair in 'starts' is seeded into the forward fringe
+   * with the offset as its initial distance, and likewise for 'ends' into the
+   * backward fringe. A single search then finds the best (start, end) pair,
+   * i.e. the one minimizing start offset + path weight + end offset.
+   * Offsets cannot be negative.
+   *
+   * If 'kNearest' is greater than 0, the forward search is continued after
+   * solving until the 'kNearest' ends closest to the starts are known.
+   * Read nearestEnds() for the results.
   */
-  BiDijkstraSolver(const Graph<Vertex>& input, Vertex start,
-                          Vertex end, const double& timeout);
+  BiDijkstraSolver(const GraphType& input,
+                   const std::vector<std::pair<Vertex, double>>& starts,
+                   const std::vector<std::pair<Vertex, double>>& ends,
+                   const double& timeout, const int kNearest = 0,
+                   const bool distanceOnly = false);
 
   /*
    * Dtor.
@@ -37,26 +126,122 @@ template <typename Vertex> class BiDijkstraSolver {
   ~BiDijkstraSolver() { }
 
   /*
-   * Returns 1 for 'solved', 0 for 'unsolvable', -1 for 'timed-out'.
+   * Returns 1 for 'solved', 0 for 'unsolvable', -1 for 'timed-out', -2 for
+   * 'out of bounds' (see SearchBounds).
   */
   int outcome() { return outcome_; }
 
   /*
    * A vector of vertices corresponding to the solution, from start to end.
    * Returns an uninitialized (empty) vector if problem was unsolvable or
-   * solving timed out.
+   * solving timed out, or in distance-only mode.
+   *
+   * The vector is only built on the first call; callers that do not need
+   * the path pay nothing for it. Use copySolution() to avoid allocating.
   */
-  const std::vector<Vertex>& solution() { return solution_; }
+  const std::vector<Vertex>& solution();
 
   /*
-   * The total weight of the solution, taking into account edge weights.
+   * The number of vertices in the solution (0 if there is none), without
+   * building it. The size is remembered once known.
+  */
+  int solutionSize();
+
+  /*
+   * Writes the solution's vertices, from start to end, into 'vertices',
+   * and unless 'weights' is null, the weight of the edge from vertices[i]
+   * to vertices[i + 1] into weights[i]. Edge weights are recovered from
+   * the search's distances, so are exact up to floating-point rounding.
+   *
+   * Returns solutionSize(). If that is more than 'capacity', the buffers
+   * hold nothing meaningful (though they may have been written to, within
+   * 'capacity', when the size was not known yet) and callers can retry
+   * with a large enough buffer. Both trees are walked once per call.
+  */
+  int copySolution(Vertex* vertices, double* weights, const int capacity);
+
+  /*
+   * The total weight of the solution, taking into account edge weights
+   * (and offsets, for multi-source/multi-target problems).
    * Returns std::numeric_limits<double>::infinity() if problem was
    * unsolvable or solving timed out.
   */
   double solutionWeight() { return solutionWeight_; }
 
   /*
-   * The total number of states explored while solving.
+   * What is known of the shortest path's weight when the search stopped
+   * early (timed-out or out of bounds): it lies between lowerBound() and
+   * bestWeightFound(), the weight of the best path seen so far (infinity
+   * if none). Both equal solutionWeight() if solved.
+  */
+  double lowerBound() { return lowerBound_; }
+  double bestWeightFound() { return bestWeightFound_; }
+
+  /*
+   * The start and end vertices of the solution, for multi-source/
+   * multi-target problems. Must only be called if the problem was solved
+   * (outcome() == 1) and predecessors were kept (not 'distanceOnly').
+  */
+  Vertex solutionStart() {
+    assert(outcome_ == 1 && !distanceOnly_);
+    return solution().front();
+  }
+  Vertex solutionEnd() {
+    assert(outcome_ == 1 && !distanceOnly_);
+    return solution().back();
+  }
+
+  /*
+   * The (up to 'kNearest') ends closest to the starts, each paired with
+   * its total weight, closest first. Empty unless 'kNearest' was given.
+  */
+  const std::vector<std::pair<Vertex, double>>& nearestEnds() {
+    return nearestEnds_;
+  }
+
+  /*
+   * Whether nearestEnds() holds the 'kNearest' closest ends (or every
+   * reachable end, if there are fewer). False if the problem was not
+   * solved, or if the time-out cut the search for them short; the
+   * solution itself is still exact in that case.
+  */
+  bool nearestEndsComplete() { return nearestEndsComplete_; }
+
+  /*
+   * Continues both searches of a solved problem until neither fringe
+   * holds a vertex closer than (1 + 'stretch') times the solution's
+   * weight to its start (or end), so that every path up to that weight
+   * runs through vertices settled in both directions. Used by solvers
+   * built on the search trees, e.g. AlternativeRouteSolver.
+   *
+   * Returns false if it timed out, or is not applicable: the problem was
+   * not solved, or was solved in A* mode (whose fringes are not ordered
+   * by distance). The solution itself is left unchanged either way.
+  */
+  bool exploreBeyond(const GraphType& input, const double stretch,
+                     const double& timeout);
+
+  /*
+   * Read-only access to the search trees. forwardTree() maps every vertex
+   * reached by the forward search to its predecessor towards the start,
+   * and forwardDistances() to its distance from the start (likewise
+   * backwards, towards the end). A vertex whose shortest distance is
+   * known is settled; see isSettled(). The trees are empty in
+   * distance-only mode.
+  */
+  const std::map<Vertex, Vertex>& forwardTree() { return forwardEdgeTo; }
+  const std::map<Vertex, Vertex>& backwardTree() { return backwardEdgeTo; }
+  const std::map<Vertex, double>& forwardDistances() {
+    return forwardDistTo;
+  }
+  const std::map<Vertex, double>& backwardDistances() {
+    return backwardDistTo;
+  }
+  bool isSettled(const bool forward, const Vertex& v);
+
+  /*
+   * The total number of states explored while solving (and by
+   * exploreBeyond()).
   */
   int numStatesExplored() { return numStatesExplored_; }
 
@@ -67,14 +252,14 @@ template <typename Vertex> class BiDijkstraSolver {
   double explorationTime() { return timeSpent; }
 
  private:
-  /* 
+  /*
    * Data structures to keep track of the forward path.
   */
   ExtrinsicMinPQ<Vertex> forwardFringe;
   std::map<Vertex, Vertex> forwardEdgeTo;
   std::map<Vertex, double> forwardDistTo;
 
-  /* 
+  /*
    * Data structures to keep track of the backward path.
   */
   ExtrinsicMinPQ<Vertex> backwardFringe;
@@ -82,13 +267,68 @@ template <typename Vertex> class BiDijkstraSolver {
   std::map<Vertex, double> backwardDistTo;
 
   /*
-   * Results.
+   * Ends that have been settled by the forward search, keyed by their
+   * total weight. Only kept track of when 'kNearest' is given.
   */
+  std::map<Vertex, double> endOffsets;
+  std::set<std::pair<double, Vertex>> settledEnds;
+
+  /*
+   * A* potentials; no coordinates (null) for plain Dijkstra's.
+  */
+  const Coordinates* coordinates_;
+  double maxSpeed_;
+  Vertex start_;
+  Vertex end_;
+
+  /*
+   * Limits of a bounded search, and whether any vertex was left out for
+   * being too far.
+  */
+  SearchBounds bounds_;
+  bool pruned;
+
+  /*
+   * Results. The solution is kept as the vertex where the two searches
+   * met, 'mid_', until solution() is called.
+  */
+  bool distanceOnly_;
   int outcome_;
+  Vertex mid_;
+  bool materialized;
   std::vector<Vertex> solution_;
+  int solutionSize_;  // -1 until known.
   double solutionWeight_;
+  double lowerBound_;
+  double bestWeightFound_;
+  std::vector<std::pair<Vertex, double>> nearestEnds_;
+  bool nearestEndsComplete_;
   int numStatesExplored_;
   double timeSpent;
+
+  /*
+   * Returns the forward (or backward) potential of 'v', 0 without
+   * coordinates. Fringe priorities are distances plus potentials.
+  */
+  double potential(const bool forward, const Vertex& v) const;
+
+  /*
+   * Runs the search shared by both ctors.
+  */
+  void solve(const GraphType& input,
+             const std::vector<std::pair<Vertex, double>>& starts,
+             const std::vector<std::pair<Vertex, double>>& ends,
+             const double& timeout, const int kNearest,
+             std::chrono::high_resolution_clock::time_point start_time);
+
+  /*
+   * Settles the vertex with the smallest distance in the forward (or
+   * backward) fringe and relaxes its outgoing (or incoming) edges.
+   * Updates 'mu'/'mid' whenever a relaxed vertex has been reached in
+   * both directions and the path through it is the best seen so far.
+  */
+  void settleNext(const GraphType& input, const bool forward,
+                  double* mu, Vertex* mid);
 };
 
 #include "BiDijkstraSolver.cpp"
@@ -0,0 +1,288 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <algorithm>
+#include <utility>  // For pair
+#include <limits>  // For numeric_limits
+#include <chrono>  // For high_resolution_clock and duration
+#include "KShortestPathsSolver.h"
+#include "../trace/SearchTrace.h"
+
+template <typename Vertex, typename GraphType>
+KShortestPathsSolver<Vertex, GraphType>::KShortestPathsSolver(
+                const GraphType& input,
+                Vertex start, Vertex end,
+                const int k, const double& timeout) {
+  auto start_time = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed;
+
+  // Initially, assume that problem is 'unsolvable'.
+  outcome_ = 0;
+  numStatesExplored_ = 0;
+  double shortest = std::numeric_limits<double>::infinity();
+  TRACE_QUERY(&outcome_, &shortest, &numStatesExplored_);
+
+  /* -------------- Backward search from the end vertex. -------------- */
+  // Only far enough to settle 'start'; Yen's loop grows it further when
+  // needed.
+  backward_.add(end, 0.0);
+  distToEnd[end] = 0.0;
+  nextToEnd[end] = end;
+  radius_ = 0.0;
+  while (settledToEnd.count(start) == 0 && settleBackward(input)) {
+    // Check if algorithm's taking longer than specified.
+    elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (elapsed.count() > timeout) {
+      TRACE_TIMEOUT(numStatesExplored_);
+      outcome_ = -1;  // Update 'outcome_' to -1 for 'timed-out'.
+      timeSpent = elapsed.count();
+      return;
+    }
+  }
+
+  if (settledToEnd.count(start) == 0 || k < 1) {
+    elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    timeSpent = elapsed.count();
+    return;
+  }
+  outcome_ = 1;
+  shortest = distToEnd[start];
+
+  /* ------------ Shortest path, straight off the backward tree. ------------ */
+  std::vector<std::vector<double>> cumulatives;
+  std::vector<Vertex> first;
+  std::vector<double> firstCumulative;
+  Vertex trace = start;
+  first.push_back(trace);
+  firstCumulative.push_back(0.0);
+  while (trace != end) {
+    trace = nextToEnd[trace];
+    first.push_back(trace);
+    firstCumulative.push_back(distToEnd[start] - distToEnd[trace]);
+  }
+  paths_.push_back(first);
+  pathWeights_.push_back(distToEnd[start]);
+  cumulatives.push_back(firstCumulative);
+
+  /* ------------------------ Yen's algorithm. ------------------------ */
+  // Candidate paths, keyed by their vertices alone so that a path found
+  // by several spurs, with weights differing only by rounding, is kept
+  // once. Maps to cumulative weights; 'byWeight' orders them cheapest
+  // first.
+  std::map<std::vector<Vertex>, std::vector<double>> candidates;
+  std::set<std::pair<double, std::vector<Vertex>>> byWeight;
+  std::set<std::vector<Vertex>> accepted(paths_.begin(), paths_.end());
+  std::vector<Vertex> spurPath;
+  std::vector<double> spurCumulative;
+  while (static_cast<int>(paths_.size()) < k) {
+    const std::vector<Vertex> last = paths_.back();
+    const std::vector<double> lastCumulative = cumulatives.back();
+
+    // Settle every vertex of 'last' in the backward search, so that the
+    // spur searches start from exact distances. The radius never exceeds
+    // the weight of the k-th path.
+    while (!backward_.isEmpty() && radius_ < pathWeights_.back()
+           && settleBackward(input)) {
+      elapsed = std::chrono::high_resolution_clock::now() - start_time;
+      if (elapsed.count() > timeout) {
+        TRACE_TIMEOUT(numStatesExplored_);
+        outcome_ = -1;  // Update 'outcome_' to -1 for 'timed-out'.
+        timeSpent = elapsed.count();
+        return;
+      }
+    }
+
+    for (size_t i = 0; i + 1 < last.size(); i++) {
+      const Vertex& spur = last[i];
+
+      // Remove the next edge of every accepted path sharing this root...
+      std::set<Vertex> removedNext;
+      for (auto& p : paths_) {
+        if (p.size() > i + 1 && std::equal(last.begin(),
+                                           last.begin() + i + 1, p.begin()))
+          removedNext.insert(p[i + 1]);
+      }
+      // ...and the root path itself, so spur paths stay loopless.
+      std::set<Vertex> removedVertices(last.begin(), last.begin() + i);
+
+      if (spurSearch(input, spur, end, removedVertices, removedNext,
+                     &spurPath, &spurCumulative)) {
+        std::vector<Vertex> total(last.begin(), last.begin() + i);
+        std::vector<double> totalCumulative(lastCumulative.begin(),
+                                            lastCumulative.begin() + i);
+        total.insert(total.end(), spurPath.begin(), spurPath.end());
+        for (auto& c : spurCumulative)
+          totalCumulative.push_back(lastCumulative[i] + c);
+        double weight = totalCumulative.back();
+        auto known = candidates.find(total);
+        if (known == candidates.end()) {
+          byWeight.insert(std::make_pair(weight, total));
+          candidates[total] = totalCumulative;
+        } else if (weight < known->second.back()) {
+          byWeight.erase(std::make_pair(known->second.back(), total));
+          byWeight.insert(std::make_pair(weight, total));
+          known->second = totalCumulative;
+        }
+      }
+
+      // Check if algorithm's taking longer than specified.
+      elapsed = std::chrono::high_resolution_clock::now() - start_time;
+      if (elapsed.count() > timeout) {
+        TRACE_TIMEOUT(numStatesExplored_);
+        outcome_ = -1;  // Update 'outcome_' to -1 for 'timed-out'.
+        timeSpent = elapsed.count();
+        return;
+      }
+    }
+
+    // Drop candidates that were accepted already.
+    while (!byWeight.empty() && accepted.count(byWeight.begin()->second) > 0) {
+      candidates.erase(byWeight.begin()->second);
+      byWeight.erase(byWeight.begin());
+    }
+
+    // No more simple paths.
+    if (byWeight.empty())
+      break;
+
+    auto best = candidates.find(byWeight.begin()->second);
+    paths_.push_back(best->first);
+    pathWeights_.push_back(byWeight.begin()->first);
+    cumulatives.push_back(best->second);
+    accepted.insert(best->first);
+    candidates.erase(best);
+    byWeight.erase(byWeight.begin());
+  }
+
+  // Extract and record total time.
+  elapsed = std::chrono::high_resolution_clock::now() - start_time;
+  timeSpent = elapsed.count();
+}
+
+template <typename Vertex, typename GraphType>
+bool KShortestPathsSolver<Vertex, GraphType>::settleBackward(
+                                                  const GraphType& input) {
+  if (backward_.isEmpty())
+    return false;
+  Vertex* v = backward_.removeSmallest();
+  numStatesExplored_++;
+  settledToEnd.insert(*v);
+  radius_ = distToEnd[*v];
+  TRACE_SETTLE(false, *v, radius_, backward_.size());
+
+  for (auto& edge : input.incomingNeighbors(*v)) {
+    Vertex w = edgeTarget(edge);
+    double dist = radius_ + edgeWeight(edge);
+    if (distToEnd.find(w) == distToEnd.end()) {
+      backward_.add(w, dist);
+      nextToEnd[w] = *v;
+      distToEnd[w] = dist;
+    } else if (dist < distToEnd[w]) {
+      backward_.changePriority(w, dist);
+      nextToEnd[w] = *v;
+      distToEnd[w] = dist;
+    }
+  }
+  delete v;
+  return true;
+}
+
+template <typename Vertex, typename GraphType>
+bool KShortestPathsSolver<Vertex, GraphType>::toEnd(const Vertex& v,
+                                                    double* h) {
+  if (settledToEnd.count(v) > 0) {
+    *h = distToEnd[v];
+    return true;
+  }
+  // Not settled: at least the radius away, or unable to reach the end
+  // at all once the backward search ran out.
+  *h = radius_;
+  return !backward_.isEmpty();
+}
+
+template <typename Vertex, typename GraphType>
+bool KShortestPathsSolver<Vertex, GraphType>::spurSearch(
+                              const GraphType& input,
+                              const Vertex& spur, const Vertex& end,
+                              const std::set<Vertex>& removedVertices,
+                              const std::set<Vertex>& removedNext,
+                              std::vector<Vertex>* spurPath,
+                              std::vector<double>* cumulative) {
+  spurPath->clear();
+  cumulative->clear();
+
+  // Fast path: reuse the backward tree's path if nothing on it was removed.
+  bool clean = (spur == end) || (settledToEnd.count(spur) > 0 &&
+                                 removedNext.count(nextToEnd[spur]) == 0);
+  Vertex trace = spur;
+  spurPath->push_back(trace);
+  cumulative->push_back(0.0);
+  while (clean && trace != end) {
+    trace = nextToEnd[trace];
+    if (removedVertices.count(trace) > 0)
+      clean = false;
+    spurPath->push_back(trace);
+    cumulative->push_back(distToEnd[spur] - distToEnd[trace]);
+  }
+  if (clean)
+    return true;
+
+  // Otherwise, A* with the backward search's distances as the heuristic.
+  ExtrinsicMinPQ<Vertex> fringe;
+  std::map<Vertex, Vertex> edgeTo;
+  std::map<Vertex, double> distTo;
+  double h;
+  toEnd(spur, &h);
+  fringe.add(spur, h);
+  edgeTo[spur] = spur;
+  distTo[spur] = 0.0;
+  while (!fringe.isEmpty()) {
+    Vertex* ptr = fringe.removeSmallest();
+    Vertex a = *ptr;
+    delete ptr;
+    numStatesExplored_++;
+    TRACE_SETTLE(true, a, distTo[a], fringe.size());
+
+    if (a == end) {
+      spurPath->clear();
+      cumulative->clear();
+      trace = end;
+      spurPath->push_back(trace);
+      while (trace != spur) {
+        trace = edgeTo[trace];
+        spurPath->push_back(trace);
+      }
+      std::reverse(spurPath->begin(), spurPath->end());
+      for (auto& v : *spurPath)
+        cumulative->push_back(distTo[v]);
+      return true;
+    }
+
+    double prevDist = distTo[a];
+    for (auto& edge : input.outgoingNeighbors(a)) {
+      Vertex b = edgeTarget(edge);
+      if (removedVertices.count(b) > 0)
+        continue;
+      if (a == spur && removedNext.count(b) > 0)
+        continue;
+      // Vertices that cannot reach the end are never worth adding.
+      if (!toEnd(b, &h))
+        continue;
+
+      double dist = prevDist + edgeWeight(edge);
+      if (distTo.find(b) == distTo.end()) {
+        fringe.add(b, dist + h);
+        edgeTo[b] = a;
+        distTo[b] = dist;
+      } else if (dist < distTo[b]) {
+        fringe.changePriority(b, dist + h);
+        edgeTo[b] = a;
+        distTo[b] = dist;
+      }
+    }
+  }
+  return false;
+}
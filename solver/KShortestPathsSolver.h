@@ -0,0 +1,142 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef KSHORTESTPATHSSOLVER_H_
+#define KSHORTESTPATHSSOLVER_H_
+
+#include <map>
+#include <set>
+#include <vector>
+#include "../graph/Graph.h"
+#include "../graph/StaticGraph.h"
+#include "../pq/ExtrinsicMinPQ.h"
+
+/*
+ * Class for finding the k shortest simple (loopless) paths between two
+ * vertices, using Yen's algorithm.
+ *
+ * Work is shared across Yen's spur searches through one backward
+ * search from the end vertex. It runs only until it settles the start
+ * vertex, and before the spur searches along the i-th path it is resumed
+ * up to that path's weight, so it never settles vertices farther from
+ * the end than the k-th path is long. Settled vertices have exact
+ * distances to the end, and every other vertex is at least the search
+ * radius away. Removing edges/vertices for a spur search can only make
+ * distances longer, so this is a consistent A* heuristic for every spur
+ * search. Moreover, whenever the backward search tree's own path from a
+ * settled spur vertex avoids everything that was removed, it is the spur
+ * path and no search is needed at all.
+ *
+ * Like BiDijkstraSolver, the solving is performed in the constructor.
+*/
+template <typename Vertex, typename GraphType = Graph<Vertex>>
+class KShortestPathsSolver {
+  static_assert(IsStaticGraph<GraphType, Vertex>::value,
+                "See graph/StaticGraph.h for requirements on GraphType.");
+
+ public:
+  /*
+   * Ctor.
+   * Finds up to 'k' shortest simple paths from 'start' to 'end'.
+   * The timeout is given in seconds.
+   *
+   * Read "graph/Graph.h" (or "graph/StaticGraph.h") for further documentation
+   * on requirements for 'input'.
+  */
+  KShortestPathsSolver(const GraphType& input, Vertex start,
+                       Vertex end, const int k, const double& timeout);
+
+  /*
+   * Dtor.
+  */
+  ~KShortestPathsSolver() { }
+
+  /*
+   * Returns 1 for 'solved', 0 for 'unsolvable', -1 for 'timed-out'.
+   * On time-out, the paths found so far remain available.
+  */
+  int outcome() { return outcome_; }
+
+  /*
+   * The number of paths found. May be less than 'k' if the graph does
+   * not contain that many simple paths from start to end.
+  */
+  int numPaths() { return paths_.size(); }
+
+  /*
+   * A vector of vertices corresponding to the i-th shortest path, from
+   * start to end.
+  */
+  const std::vector<Vertex>& path(const int i) { return paths_[i]; }
+
+  /*
+   * The total weight of the i-th shortest path.
+  */
+  double pathWeight(const int i) { return pathWeights_[i]; }
+
+  /*
+   * The total number of states explored while solving, including the
+   * backward search.
+  */
+  int numStatesExplored() { return numStatesExplored_; }
+
+  /*
+   * The total time spent in seconds by the constructor.
+  */
+  double explorationTime() { return timeSpent; }
+
+ private:
+  /*
+   * Backward search from the end vertex: distance from each vertex to
+   * the end, and the next vertex on the path towards it. Both are exact
+   * for vertices in 'settledToEnd'. 'radius_' is the distance of the
+   * vertex settled last.
+  */
+  ExtrinsicMinPQ<Vertex> backward_;
+  std::map<Vertex, double> distToEnd;
+  std::map<Vertex, Vertex> nextToEnd;
+  std::set<Vertex> settledToEnd;
+  double radius_;
+
+  /*
+   * Results.
+  */
+  int outcome_;
+  std::vector<std::vector<Vertex>> paths_;
+  std::vector<double> pathWeights_;
+  int numStatesExplored_;
+  double timeSpent;
+
+  /*
+   * Settles the next vertex of the backward search. Returns false if
+   * there is none left.
+  */
+  bool settleBackward(const GraphType& input);
+
+  /*
+   * Sets 'h' to a lower bound on the distance from 'v' to the end: exact
+   * if 'v' is settled, the radius otherwise. Returns false if 'v' cannot
+   * reach the end at all.
+  */
+  bool toEnd(const Vertex& v, double* h);
+
+  /*
+   * Finds the shortest path from 'spur' to 'end' that avoids the vertices
+   * in 'removedVertices' and does not leave 'spur' through an edge to a
+   * vertex in 'removedNext'. 'cumulative' receives the weight from
+   * 'spur' to each vertex on the path. Returns false if no such path
+   * exists.
+  */
+  bool spurSearch(const GraphType& input, const Vertex& spur,
+                  const Vertex& end, const std::set<Vertex>& removedVertices,
+                  const std::set<Vertex>& removedNext,
+                  std::vector<Vertex>* spurPath,
+                  std::vector<double>* cumulative);
+};
+
+#include "KShortestPathsSolver.cpp"
+
+#endif  // KSHORTESTPATHSSOLVER_H_
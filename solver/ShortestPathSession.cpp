@@ -0,0 +1,160 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <algorithm>
+#include <limits>  // For numeric_limits
+#include <chrono>  // For high_resolution_clock and duration
+#include "ShortestPathSession.h"
+
+template <typename Vertex, typename GraphType>
+ShortestPathSession<Vertex, GraphType>::ShortestPathSession(
+                const GraphType& input, Vertex start) :
+                input_(input), start_(start), numForwardSettled_(0),
+                outcome_(0),
+                solutionWeight_(std::numeric_limits<double>::infinity()),
+                numStatesExplored_(0), timeSpent(0) {
+  // A vertex that maps to itself in 'forwardEdgeTo' is the start.
+  forwardFringe.add(start, 0.0);
+  forwardEdgeTo[start] = start;
+  forwardDistTo[start] = 0.0;
+}
+
+template <typename Vertex, typename GraphType>
+int ShortestPathSession<Vertex, GraphType>::query(Vertex end,
+                                                  const double& timeout) {
+  auto start_time = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed;
+
+  // Initially, assume that problem is 'unsolvable'.
+  outcome_ = 0;
+  solution_.clear();
+  solutionWeight_ = std::numeric_limits<double>::infinity();
+  numStatesExplored_ = 0;
+  TRACE_QUERY(&outcome_, &solutionWeight_, &numStatesExplored_);
+
+  // Drop the previous query's backward search.
+  while (!backwardFringe.isEmpty())
+    delete backwardFringe.removeSmallest();
+  backwardEdgeTo.clear();
+  backwardDistTo.clear();
+
+  // 'mu' is the weight of the best path seen so far, through 'mid'.
+  double mu = std::numeric_limits<double>::infinity();
+  Vertex mid = end;
+  auto reached = forwardDistTo.find(end);
+  if (reached != forwardDistTo.end())
+    mu = reached->second;
+
+  // An end already settled by the forward search needs no search at all.
+  bool settled = reached != forwardDistTo.end() &&
+                 !forwardFringe.contains(end);
+  if (!settled) {
+    backwardFringe.add(end, 0.0);
+    backwardEdgeTo[end] = end;
+    backwardDistTo[end] = 0.0;
+
+    // Alternate between the two directions while both fringes are
+    // non-empty. The forward fringe is wherever the earlier queries left
+    // it, so the forward search tends to be far ahead of the backward one;
+    // every vertex it settles now stays settled for later queries.
+    bool forward = false;
+    while (!forwardFringe.isEmpty() && !backwardFringe.isEmpty()) {
+      // Same stopping rule as BiDijkstraSolver.
+      if (forwardDistTo[*forwardFringe.getSmallest()] +
+          backwardDistTo[*backwardFringe.getSmallest()] >= mu)
+        break;
+
+      settleNext(forward, &mu, &mid);
+      forward = !forward;
+
+      // Check if algorithm's taking longer than specified.
+      elapsed = std::chrono::high_resolution_clock::now() - start_time;
+      if (elapsed.count() > timeout) {
+        TRACE_TIMEOUT(numStatesExplored_);
+        outcome_ = -1;  // Update 'outcome_' to -1 for 'timed-out'.
+        timeSpent = elapsed.count();  // Record time.
+        return outcome_;
+      }
+    }
+  }
+
+  // Path was found; populate the 'solution_' vector and update
+  // 'solutionWeight_'.
+  if (mu < std::numeric_limits<double>::infinity()) {
+    outcome_ = 1;
+
+    /* -- Forward path's vertices (including 'mid' vertex). -- */
+    Vertex trace = mid;
+    solution_.push_back(trace);
+    while (forwardEdgeTo[trace] != trace) {
+      trace = forwardEdgeTo[trace];
+      solution_.push_back(trace);
+    }
+    std::reverse(solution_.begin(), solution_.end());
+
+    /* -- Backward path's vertices (excluding 'mid' vertex). -- */
+    trace = mid;
+    while (!settled && backwardEdgeTo[trace] != trace) {
+      trace = backwardEdgeTo[trace];
+      solution_.push_back(trace);
+    }
+
+    solutionWeight_ = mu;
+  }
+
+  // Extract and record total time.
+  elapsed = std::chrono::high_resolution_clock::now() - start_time;
+  timeSpent = elapsed.count();
+  return outcome_;
+}
+
+template <typename Vertex, typename GraphType>
+void ShortestPathSession<Vertex, GraphType>::settleNext(const bool forward,
+                                                        double* mu,
+                                                        Vertex* mid) {
+  ExtrinsicMinPQ<Vertex>& fringe = forward ? forwardFringe : backwardFringe;
+  std::map<Vertex, Vertex>& edgeTo = forward ? forwardEdgeTo : backwardEdgeTo;
+  std::map<Vertex, double>& distTo = forward ? forwardDistTo : backwardDistTo;
+  std::map<Vertex, double>& otherDistTo =
+                          forward ? backwardDistTo : forwardDistTo;
+
+  // Once removed from fringe. Shortest path to this vertex is established.
+  Vertex* a = fringe.removeSmallest();
+  numStatesExplored_++;
+  if (forward)
+    numForwardSettled_++;
+
+  // Relax the removed vertex's neighbors.
+  double prevDist = distTo[*a];
+  TRACE_SETTLE(forward, *a, prevDist, fringe.size());
+  auto&& edges =
+      forward ? input_.outgoingNeighbors(*a) : input_.incomingNeighbors(*a);
+  for (auto& edge : edges) {
+    Vertex b = edgeTarget(edge);
+    double dist = prevDist + edgeWeight(edge);
+    if (distTo.find(b) == distTo.end()) {
+      fringe.add(b, dist);
+      edgeTo[b] = *a;
+      distTo[b] = dist;
+    } else if (dist < distTo[b]) {
+      fringe.changePriority(b, dist);
+      edgeTo[b] = *a;
+      distTo[b] = dist;
+    }
+
+    // Both directions reached this vertex; check the path through it.
+    // Forward distances from earlier queries count just the same.
+    auto other = otherDistTo.find(b);
+    if (other != otherDistTo.end() && distTo[b] + other->second < *mu) {
+      *mu = distTo[b] + other->second;
+      *mid = b;
+      TRACE_MEET(b, *mu);
+    }
+  }
+
+  // Clean up.
+  delete a;
+}
@@ -0,0 +1,122 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef SHORTESTPATHSESSION_H_
+#define SHORTESTPATHSESSION_H_
+
+#include <map>
+#include <vector>
+#include "../graph/Graph.h"
+#include "../graph/StaticGraph.h"
+#include "../pq/ExtrinsicMinPQ.h"
+#include "../trace/SearchTrace.h"
+
+/*
+ * Class for answering a series of shortest-path queries from one fixed
+ * start vertex to changing end vertices, e.g. a moving target.
+ *
+ * Unlike BiDijkstraSolver, which starts from scratch every time, the
+ * session keeps its forward search (fringe, distances, edgeTo) alive
+ * between queries. Each query runs the Bidirectional Dijkstra's Algorithm
+ * with a fresh backward search from the new end, while the forward search
+ * resumes where the previous queries left it and only settles as far as
+ * this query needs. An end that the forward search has already settled
+ * is answered straight from the forward search tree, without any search.
+ *
+ * The graph must outlive the session and must not change during it.
+*/
+template <typename Vertex, typename GraphType = Graph<Vertex>>
+class ShortestPathSession {
+  static_assert(IsStaticGraph<GraphType, Vertex>::value,
+                "See graph/StaticGraph.h for requirements on GraphType.");
+
+ public:
+  /*
+   * Ctor.
+   * Starts a session of queries from 'start'. No search is done yet.
+   *
+   * Read "graph/Graph.h" (or "graph/StaticGraph.h") for further documentation
+   * on requirements for 'input'.
+  */
+  ShortestPathSession(const GraphType& input, Vertex start);
+
+  /*
+   * Dtor.
+  */
+  ~ShortestPathSession() { }
+
+  /*
+   * Solves the shortest-path problem from the session's start to 'end'.
+   * The timeout is given in seconds. Returns the outcome, as outcome().
+   * On time-out, the forward search's progress is kept for later queries.
+  */
+  int query(Vertex end, const double& timeout);
+
+  /*
+   * The session's start vertex.
+  */
+  Vertex start() { return start_; }
+
+  /*
+   * Results of the last query, as for BiDijkstraSolver.
+   * outcome() returns 1 for 'solved', 0 for 'unsolvable', -1 for
+   * 'timed-out'. numStatesExplored() counts the states explored by the
+   * last query only, in both directions.
+  */
+  int outcome() { return outcome_; }
+  const std::vector<Vertex>& solution() { return solution_; }
+  double solutionWeight() { return solutionWeight_; }
+  int numStatesExplored() { return numStatesExplored_; }
+  double explorationTime() { return timeSpent; }
+
+  /*
+   * The number of vertices settled by the forward search over all
+   * queries so far.
+  */
+  int numForwardSettled() { return numForwardSettled_; }
+
+ private:
+  const GraphType& input_;
+  Vertex start_;
+
+  /*
+   * Data structures to keep track of the forward path; kept for the
+   * whole session.
+  */
+  ExtrinsicMinPQ<Vertex> forwardFringe;
+  std::map<Vertex, Vertex> forwardEdgeTo;
+  std::map<Vertex, double> forwardDistTo;
+  int numForwardSettled_;
+
+  /*
+   * Data structures to keep track of the backward path; cleared by
+   * every query.
+  */
+  ExtrinsicMinPQ<Vertex> backwardFringe;
+  std::map<Vertex, Vertex> backwardEdgeTo;
+  std::map<Vertex, double> backwardDistTo;
+
+  /*
+   * Results of the last query.
+  */
+  int outcome_;
+  std::vector<Vertex> solution_;
+  double solutionWeight_;
+  int numStatesExplored_;
+  double timeSpent;
+
+  /*
+   * Settles the vertex with the smallest distance in the forward (or
+   * backward) fringe and relaxes its outgoing (or incoming) edges.
+   * Updates 'mu'/'mid' whenever a relaxed vertex has been reached in
+   * both directions and the path through it is the best seen so far.
+  */
+  void settleNext(const bool forward, double* mu, Vertex* mid);
+};
+
+#include "ShortestPathSession.cpp"
+
+#endif  // SHORTESTPATHSESSION_H_
@@ -0,0 +1,256 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <set>
+#include "SearchTrace.h"
+
+/*
+ * Binary trace files: this magic, followed by one record per event, each
+ * kTraceRecordSize bytes in the machine's byte order: the thread (uint32),
+ * then the event's time, vertex, value, query, count, type and forward
+ * fields, packed in that order.
+*/
+static const char kTraceMagic[8] = {'B', 'D', 'T', 'R', 'A', 'C', 'E', '1'};
+static const size_t kTraceRecordSize = 4 + 8 + 8 + 8 + 4 + 4 + 1 + 1;
+
+inline TraceBuffer::TraceBuffer(const int capacity, const int thread) :
+                               thread_(thread), head_(0), cleared_(0) {
+  uint64_t size = 1;
+  while (size < static_cast<uint64_t>(std::max(capacity, 1)))
+    size *= 2;
+  words_.reset(new std::atomic<uint64_t>[size * kTraceEventWords]);
+  mask_ = size - 1;
+}
+
+inline std::vector<TraceEvent> TraceBuffer::snapshot() const {
+  uint64_t head = head_.load(std::memory_order_acquire);
+  uint64_t first = std::max(cleared_.load(), head > mask_ ? head - mask_ - 1
+                                                          : 0);
+  std::vector<TraceEvent> events(head - first);
+  for (uint64_t i = first; i < head; i++) {
+    const std::atomic<uint64_t>* slot = &words_[(i & mask_) *
+                                                kTraceEventWords];
+    uint64_t words[kTraceEventWords];
+    for (size_t w = 0; w < kTraceEventWords; w++)
+      words[w] = slot[w].load(std::memory_order_acquire);
+    memcpy(&events[i - first], words, sizeof(TraceEvent));
+  }
+
+  // Events the writer got to meanwhile, including the one it may be
+  // writing now, may be torn; drop them.
+  uint64_t now = head_.load(std::memory_order_acquire);
+  if (now > mask_ && now - mask_ > first) {
+    uint64_t overwritten = std::min(now - mask_ - first,
+                                    static_cast<uint64_t>(events.size()));
+    events.erase(events.begin(), events.begin() + overwritten);
+  }
+  return events;
+}
+
+inline SearchTracer::SearchTracer() : enabled_(false), sampling_(1),
+                                     capacity_(1 << 16), nextQuery_(1),
+                                     epoch_(std::chrono::steady_clock::now()) {
+}
+
+inline SearchTracer& SearchTracer::instance() {
+  static SearchTracer tracer;
+  return tracer;
+}
+
+inline bool SearchTracer::beginQuery() {
+  ThreadState& state = threadState();
+  if (!enabled_ || state.query != 0)
+    return false;
+  uint32_t query = nextQuery_++;
+  if (query == 0)  // Wrapped around; 0 means no query.
+    query = nextQuery_++;
+  if (query % sampling_ != 0)
+    return false;
+
+  if (state.buffer == nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(std::unique_ptr<TraceBuffer>(
+        new TraceBuffer(capacity_, buffers_.size())));
+    state.buffer = buffers_.back().get();
+  }
+  state.query = query;
+  record(kTraceQueryBegin, false, 0, 0.0, 0);
+  return true;
+}
+
+inline void SearchTracer::endQuery(const int outcome, const double weight,
+                                   const int states) {
+  record(kTraceQueryEnd, false, outcome, weight, states);
+  threadState().query = 0;
+}
+
+inline void SearchTracer::record(const TraceEventType type,
+                                 const bool forward, const int64_t vertex,
+                                 const double value, const int count) {
+  ThreadState& state = threadState();
+  if (state.query == 0)
+    return;
+  TraceEvent event;
+  event.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - epoch_).count();
+  event.vertex = vertex;
+  event.value = value;
+  event.query = state.query;
+  event.count = count;
+  event.type = type;
+  event.forward = forward;
+  state.buffer->record(event);
+}
+
+inline std::vector<ThreadEvent> SearchTracer::events() const {
+  std::vector<ThreadEvent> events;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& buffer : buffers_) {
+    for (auto& event : buffer->snapshot())
+      events.push_back(std::make_pair(buffer->thread(), event));
+  }
+  return events;
+}
+
+inline void SearchTracer::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& buffer : buffers_)
+    buffer->clear();
+}
+
+/*
+ * Helper function printing a number for JSON, which has no infinity.
+*/
+static inline void printJsonNumber(FILE* file, const double value) {
+  if (std::isfinite(value))
+    fprintf(file, "%.17g", value);
+  else
+    fprintf(file, "null");
+}
+
+inline bool SearchTracer::writeChromeTrace(const std::string& path) const {
+  FILE* file = fopen(path.c_str(), "w");
+  if (file == nullptr)
+    return false;
+
+  std::vector<ThreadEvent> all = events();
+  std::set<std::pair<int, uint32_t>> begun;
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  bool first = true;
+  for (auto& threadEvent : all) {
+    int thread = threadEvent.first;
+    const TraceEvent& event = threadEvent.second;
+
+    // A query whose beginning was overwritten would end a slice that was
+    // never opened; leave it out.
+    auto key = std::make_pair(thread, event.query);
+    if (event.type == kTraceQueryBegin)
+      begun.insert(key);
+    else if (begun.count(key) == 0)
+      continue;
+
+    fprintf(file, "%s\n{\"pid\":1,\"tid\":%d,\"ts\":%.3f,", first ? "" : ",",
+            thread, event.time / 1000.0);
+    first = false;
+    const char* direction = event.forward ? "forward" : "backward";
+    switch (event.type) {
+      case kTraceQueryBegin:
+        fprintf(file, "\"ph\":\"B\",\"name\":\"query %u\"}", event.query);
+        break;
+      case kTraceSettle:
+        fprintf(file, "\"ph\":\"i\",\"s\":\"t\",\"name\":\"settle\","
+                "\"args\":{\"query\":%u,\"direction\":\"%s\","
+                "\"vertex\":%lld,\"distance\":", event.query, direction,
+                static_cast<long long>(event.vertex));
+        printJsonNumber(file, event.value);
+        // Counters are per process; the id keeps threads apart.
+        fprintf(file, "}},\n{\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+                "\"ph\":\"C\",\"name\":\"%s fringe\",\"id\":%d,"
+                "\"args\":{\"size\":%u}}", thread, event.time / 1000.0,
+                direction, thread, event.count);
+        break;
+      case kTraceMeet:
+        fprintf(file, "\"ph\":\"i\",\"s\":\"t\",\"name\":\"meet\","
+                "\"args\":{\"query\":%u,\"vertex\":%lld,\"mu\":",
+                event.query, static_cast<long long>(event.vertex));
+        printJsonNumber(file, event.value);
+        fprintf(file, "}}");
+        break;
+      case kTraceTimeout:
+        fprintf(file, "\"ph\":\"i\",\"s\":\"t\",\"name\":\"timeout\","
+                "\"args\":{\"query\":%u,\"states\":%u}}", event.query,
+                event.count);
+        break;
+      default:
+        fprintf(file, "\"ph\":\"E\",\"args\":{\"outcome\":%lld,"
+                "\"states\":%u,\"weight\":",
+                static_cast<long long>(event.vertex), event.count);
+        printJsonNumber(file, event.value);
+        fprintf(file, "}}");
+        break;
+    }
+  }
+  fprintf(file, "\n]}\n");
+  return fclose(file) == 0;
+}
+
+inline bool SearchTracer::writeBinaryTrace(const std::string& path) const {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr)
+    return false;
+
+  bool ok = fwrite(kTraceMagic, sizeof(kTraceMagic), 1, file) == 1;
+  for (auto& threadEvent : events()) {
+    const TraceEvent& event = threadEvent.second;
+    uint32_t thread = threadEvent.first;
+    char record[kTraceRecordSize];
+    char* p = record;
+    memcpy(p, &thread, 4);          p += 4;
+    memcpy(p, &event.time, 8);      p += 8;
+    memcpy(p, &event.vertex, 8);    p += 8;
+    memcpy(p, &event.value, 8);     p += 8;
+    memcpy(p, &event.query, 4);     p += 4;
+    memcpy(p, &event.count, 4);     p += 4;
+    memcpy(p, &event.type, 1);      p += 1;
+    memcpy(p, &event.forward, 1);
+    ok = ok && fwrite(record, kTraceRecordSize, 1, file) == 1;
+  }
+  return fclose(file) == 0 && ok;
+}
+
+inline bool SearchTracer::readBinaryTrace(const std::string& path,
+                                          std::vector<ThreadEvent>* events) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr)
+    return false;
+
+  char magic[sizeof(kTraceMagic)];
+  bool ok = fread(magic, sizeof(magic), 1, file) == 1 &&
+            memcmp(magic, kTraceMagic, sizeof(magic)) == 0;
+  char record[kTraceRecordSize];
+  while (ok && fread(record, kTraceRecordSize, 1, file) == 1) {
+    uint32_t thread;
+    TraceEvent event;
+    const char* p = record;
+    memcpy(&thread, p, 4);          p += 4;
+    memcpy(&event.time, p, 8);      p += 8;
+    memcpy(&event.vertex, p, 8);    p += 8;
+    memcpy(&event.value, p, 8);     p += 8;
+    memcpy(&event.query, p, 4);     p += 4;
+    memcpy(&event.count, p, 4);     p += 4;
+    memcpy(&event.type, p, 1);      p += 1;
+    memcpy(&event.forward, p, 1);
+    events->push_back(std::make_pair(static_cast<int>(thread), event));
+  }
+  ok = ok && !ferror(file);
+  fclose(file);
+  return ok;
+}
@@ -0,0 +1,338 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#ifndef SEARCHTRACE_H_
+#define SEARCHTRACE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>  // For pair
+#include <vector>
+
+/*
+ * Optional tracing of how a search expands, to find out why a query is
+ * slow: which vertices it settled, in which direction and at what
+ * distance, how large the fringes grew, where the two searches met, and
+ * whether it timed out.
+ *
+ * The solvers report events through the TRACE_* macros below, which
+ * compile to nothing unless the program is compiled with
+ * -DBIDIJKSTRA_TRACE, so tracing costs nothing when compiled out. The
+ * macro must be defined (or not) for the whole program.
+ *
+ * When compiled in, tracing is still off until SearchTracer::instance()
+ * .setEnabled(true); a query then only costs one thread-local check per
+ * event. Every thread records into a ring buffer of its own, without
+ * locks, keeping the latest events once it is full. The buffers can be
+ * exported at any time, also while queries run, as Chrome trace JSON
+ * (open it in chrome://tracing or https://ui.perfetto.dev) or as a
+ * compact binary stream.
+*/
+
+/*
+ * Kinds of events.
+*/
+enum TraceEventType : uint8_t {
+  kTraceQueryBegin = 0,
+  kTraceSettle = 1,     // A vertex was settled.
+  kTraceMeet = 2,       // The best path through both searches improved.
+  kTraceTimeout = 3,    // The query timed out.
+  kTraceQueryEnd = 4
+};
+
+/*
+ * One event. Which fields are meaningful depends on its type:
+ *   kTraceSettle:   'forward', 'vertex', 'value' (its distance) and
+ *                   'count' (the fringe's size once it was removed);
+ *   kTraceMeet:     'vertex' (where the searches met), 'value' (the
+ *                   weight of the path through it);
+ *   kTraceTimeout:  'count' (states explored so far);
+ *   kTraceQueryEnd: 'vertex' (the outcome), 'value' (the solution's
+ *                   weight) and 'count' (states explored).
+*/
+struct TraceEvent {
+  uint64_t time;    // Nanoseconds since the tracer was created.
+  int64_t vertex;   // See traceVertexId().
+  double value;
+  uint32_t query;   // Query id, unique within the process.
+  uint32_t count;
+  uint8_t type;     // A TraceEventType.
+  uint8_t forward;  // 1 for the forward search, 0 for the backward one.
+};
+
+/*
+ * Number of 64-bit words a TraceEvent is stored in.
+*/
+static const size_t kTraceEventWords = (sizeof(TraceEvent) + 7) / 8;
+
+/*
+ * Single-writer ring buffer of events, owned by one recording thread.
+ *
+ * The writer never waits: it overwrites the oldest event once the buffer
+ * is full, then publishes the new total with a release store. Readers
+ * copy the events out and then drop any the writer may have overwritten
+ * meanwhile, so a snapshot never holds a torn event. Events are stored as
+ * atomic words, so that a reader copying a slot the writer is overwriting
+ * is not a data race, just a copy that gets dropped (a seqlock, with the
+ * total as the sequence). On x86, these are plain loads and stores.
+*/
+class TraceBuffer {
+ public:
+  /*
+   * Ctor.
+   * Holds up to 'capacity' events (rounded up to a power of 2), recorded
+   * by the thread numbered 'thread'. Snapshots of a full buffer hold one
+   * event less: the oldest, which the writer may be overwriting.
+  */
+  TraceBuffer(const int capacity, const int thread);
+
+  /*
+   * Dtor.
+  */
+  ~TraceBuffer() { }
+
+  /*
+   * Appends an event. Only called by the owning thread.
+  */
+  void record(const TraceEvent& event) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t words[kTraceEventWords];
+    memcpy(words, &event, sizeof(event));
+    // Release stores: a reader that sees any new word also sees the total
+    // published before it, so it knows to drop the slot (see snapshot()).
+    std::atomic<uint64_t>* slot = &words_[(head & mask_) * kTraceEventWords];
+    for (size_t i = 0; i < kTraceEventWords; i++)
+      slot[i].store(words[i], std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  /*
+   * Returns the events still in the buffer and not cleared, oldest first.
+   * Safe to call from any thread.
+  */
+  std::vector<TraceEvent> snapshot() const;
+
+  /*
+   * Discards the events recorded so far. Safe to call from any thread.
+  */
+  void clear() { cleared_.store(head_.load(std::memory_order_acquire)); }
+
+  /*
+   * Returns the number of events ever recorded, including overwritten
+   * and cleared ones.
+  */
+  uint64_t numRecorded() const { return head_.load(); }
+
+  int capacity() const { return mask_ + 1; }
+  int thread() const { return thread_; }
+
+ private:
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+  uint64_t mask_;
+  int thread_;
+  std::atomic<uint64_t> head_;     // Number of events recorded.
+  std::atomic<uint64_t> cleared_;  // Events before this one are cleared.
+};
+
+/*
+ * An event together with the thread that recorded it.
+*/
+typedef std::pair<int, TraceEvent> ThreadEvent;
+
+/*
+ * Process-wide tracing state: the switch, sampling, and the per-thread
+ * buffers.
+*/
+class SearchTracer {
+ public:
+  /*
+   * Returns the process's tracer.
+  */
+  static SearchTracer& instance();
+
+  /*
+   * Turns tracing on or off for queries started afterwards. Off by
+   * default.
+  */
+  void setEnabled(const bool enabled) { enabled_ = enabled; }
+  bool enabled() const { return enabled_; }
+
+  /*
+   * Traces only one query in every 'every' (1, the default, traces all).
+  */
+  void setSampling(const int every) { sampling_ = every < 1 ? 1 : every; }
+
+  /*
+   * Sets the capacity, in events, of buffers created afterwards (each
+   * thread's buffer is created by its first traced query). Defaults to
+   * 65536 events, i.e. 2.5 MiB per thread.
+  */
+  void setBufferCapacity(const int events) { capacity_ = events; }
+
+  /*
+   * Returns the events of all threads, each thread's oldest first.
+  */
+  std::vector<ThreadEvent> events() const;
+
+  /*
+   * Discards all events recorded so far.
+  */
+  void clear();
+
+  /*
+   * Writes all events to 'path' in Chrome's trace event format: every
+   * query is a slice on its thread's track, settled vertices, meetings
+   * and timeouts are instant events, and the fringe sizes are counters.
+   * Returns false if the file could not be written.
+  */
+  bool writeChromeTrace(const std::string& path) const;
+
+  /*
+   * Writes all events to 'path' in the binary format read by
+   * readBinaryTrace(). Returns false if the file could not be written.
+  */
+  bool writeBinaryTrace(const std::string& path) const;
+
+  /*
+   * Reads a file written by writeBinaryTrace() into 'events'.
+   * Returns false if it cannot be read or is not such a file.
+  */
+  static bool readBinaryTrace(const std::string& path,
+                              std::vector<ThreadEvent>* events);
+
+  /*
+   * Hooks used by the TRACE_* macros; see below.
+  */
+  bool beginQuery();
+  void endQuery(const int outcome, const double weight, const int states);
+  void settle(const bool forward, const int64_t vertex, const double dist,
+              const int fringeSize) {
+    record(kTraceSettle, forward, vertex, dist, fringeSize);
+  }
+  void meet(const int64_t vertex, const double mu) {
+    record(kTraceMeet, false, vertex, mu, 0);
+  }
+  void timeout(const int states) {
+    record(kTraceTimeout, false, 0, 0.0, states);
+  }
+
+  /*
+   * Returns true if the calling thread is running a traced query.
+  */
+  static bool active() { return threadState().query != 0; }
+
+ private:
+  /*
+   * What the calling thread is tracing: its buffer (created on demand)
+   * and the id of its current query, 0 if none.
+  */
+  struct ThreadState {
+    TraceBuffer* buffer;
+    uint32_t query;
+  };
+
+  std::atomic<bool> enabled_;
+  std::atomic<int> sampling_;
+  std::atomic<int> capacity_;
+  std::atomic<uint32_t> nextQuery_;
+  std::chrono::steady_clock::time_point epoch_;
+
+  mutable std::mutex mutex_;  // Guards 'buffers_' (not their contents).
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+
+  SearchTracer();
+
+  static ThreadState& threadState() {
+    static thread_local ThreadState state = {nullptr, 0};
+    return state;
+  }
+
+  /*
+   * Records an event of the calling thread's current query, if any.
+  */
+  void record(const TraceEventType type, const bool forward,
+              const int64_t vertex, const double value, const int count);
+};
+
+/*
+ * Ties a query to the calling thread for as long as it is in scope:
+ * traced (if tracing is enabled and the query is sampled) from
+ * construction, and ended, reporting the results read from the given
+ * pointers, on destruction. Queries run within a traced query (e.g. by
+ * another solver) are not traced separately.
+*/
+class SearchTraceQuery {
+ public:
+  SearchTraceQuery(const int* outcome, const double* weight,
+                   const int* states) :
+                  outcome_(outcome), weight_(weight), states_(states),
+                  traced_(SearchTracer::instance().beginQuery()) { }
+
+  ~SearchTraceQuery() {
+    if (traced_)
+      SearchTracer::instance().endQuery(*outcome_, *weight_, *states_);
+  }
+
+ private:
+  const int* outcome_;
+  const double* weight_;
+  const int* states_;
+  bool traced_;
+};
+
+/*
+ * Returns the id recorded for vertex 'v': the vertex itself for integral
+ * types, -1 otherwise. Overload it for other vertex types as needed.
+*/
+template <typename Vertex>
+inline int64_t traceVertexId(const Vertex& v) { return -1; }
+inline int64_t traceVertexId(const int& v) { return v; }
+inline int64_t traceVertexId(const long& v) { return v; }
+inline int64_t traceVertexId(const long long& v) { return v; }
+inline int64_t traceVertexId(const unsigned& v) { return v; }
+
+#ifdef BIDIJKSTRA_TRACE
+static const bool kSearchTraceCompiled = true;
+
+#define TRACE_QUERY(outcome, weight, states) \
+  SearchTraceQuery searchTraceQuery_(outcome, weight, states)
+#define TRACE_SETTLE(forward, vertex, dist, fringeSize) \
+  do { \
+    if (SearchTracer::active()) \
+      SearchTracer::instance().settle(forward, traceVertexId(vertex), \
+                                      dist, fringeSize); \
+  } while (0)
+#define TRACE_MEET(vertex, mu) \
+  do { \
+    if (SearchTracer::active()) \
+      SearchTracer::instance().meet(traceVertexId(vertex), mu); \
+  } while (0)
+#define TRACE_TIMEOUT(states) \
+  do { \
+    if (SearchTracer::active()) \
+      SearchTracer::instance().timeout(states); \
+  } while (0)
+#else
+static const bool kSearchTraceCompiled = false;
+
+// Evaluates the pointers only, so that a variable kept just for the
+// trace still counts as used.
+#define TRACE_QUERY(outcome, weight, states) \
+  static_cast<void>(outcome), static_cast<void>(weight), \
+  static_cast<void>(states)
+#define TRACE_SETTLE(forward, vertex, dist, fringeSize)
+#define TRACE_MEET(vertex, mu)
+#define TRACE_TIMEOUT(states)
+#endif
+
+#include "SearchTrace.cpp"
+
+#endif  // SEARCHTRACE_H_
@@ -0,0 +1,254 @@
+/*
+ * Author: Dat Do
+ * Contact: datdo1017@gmail.com
+ * Copyright 2020 Dat Do
+*/
+
+#include <assert.h>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SearchTrace.h"
+#include "../graph/CompactDirectedGraph.h"
+#include "../solver/AlternativeRouteSolver.h"
+#include "../solver/BiDijkstraSolver.h"
+#include "../solver/KShortestPathsSolver.h"
+#include "../solver/ShortestPathSession.h"
+
+#ifndef BIDIJKSTRA_TRACE
+#error "Build with -DBIDIJKSTRA_TRACE (see Makefile)."
+#endif
+
+/*
+ * Returns a 'side' x 'side' grid with edges both ways between neighbors.
+*/
+static CompactDirectedGraph grid(const int side) {
+  std::vector<WeightedEdge<int>> edges;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> weight(1.0, 2.0);
+  for (int r = 0; r < side; r++) {
+    for (int c = 0; c < side; c++) {
+      int v = r * side + c;
+      if (c + 1 < side) {
+        edges.push_back(WeightedEdge<int>(v, v + 1, weight(rng)));
+        edges.push_back(WeightedEdge<int>(v + 1, v, weight(rng)));
+      }
+      if (r + 1 < side) {
+        edges.push_back(WeightedEdge<int>(v, v + side, weight(rng)));
+        edges.push_back(WeightedEdge<int>(v + side, v, weight(rng)));
+      }
+    }
+  }
+  return CompactDirectedGraph(side * side, edges);
+}
+
+/*
+ * Returns the number of events of the given type.
+*/
+static int count(const std::vector<ThreadEvent>& events,
+                 const TraceEventType type) {
+  int n = 0;
+  for (auto& event : events)
+    n += event.second.type == type;
+  return n;
+}
+
+int main(int argc, char* argv[]) {
+  SearchTracer& tracer = SearchTracer::instance();
+  CompactDirectedGraph graph = grid(30);
+  const int V = graph.numVertices();
+
+  // Nothing is recorded until tracing is enabled.
+  {
+    BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, 0, V - 1, 10);
+    assert(1 == solver.outcome());
+    assert(tracer.events().empty());
+  }
+
+  // One traced query: begin, one settle per state explored, meetings
+  // down to the solution's weight, end.
+  tracer.setEnabled(true);
+  {
+    BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, 0, V - 1, 10);
+    std::vector<ThreadEvent> events = tracer.events();
+    assert(kTraceQueryBegin == events.front().second.type);
+    assert(kTraceQueryEnd == events.back().second.type);
+    assert(1 == events.back().second.vertex);
+    assert(solver.solutionWeight() == events.back().second.value);
+    assert(static_cast<uint32_t>(solver.numStatesExplored()) ==
+           events.back().second.count);
+    assert(solver.numStatesExplored() == count(events, kTraceSettle));
+    assert(0 == count(events, kTraceTimeout));
+
+    double mu = std::numeric_limits<double>::infinity();
+    bool forward = true;
+    for (size_t i = 1; i + 1 < events.size(); i++) {
+      const TraceEvent& event = events[i].second;
+      assert(event.query == events.front().second.query);
+      assert(event.time >= events[i - 1].second.time);
+      if (event.type == kTraceSettle) {
+        // The searches alternate, starting forwards.
+        assert(forward == static_cast<bool>(event.forward));
+        assert(event.vertex >= 0 && event.vertex < V);
+        forward = !forward;
+      } else if (event.type == kTraceMeet) {
+        assert(event.value < mu);
+        mu = event.value;
+      }
+    }
+    assert(solver.solutionWeight() == mu);
+  }
+
+  // So does one from a vertex to itself, which needs no search.
+  tracer.clear();
+  {
+    BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, 5, 5, 10);
+    std::vector<ThreadEvent> events = tracer.events();
+    assert(kTraceQueryBegin == events.front().second.type);
+    assert(kTraceQueryEnd == events.back().second.type);
+    assert(1 == count(events, kTraceSettle));
+    assert(1 == count(events, kTraceMeet));
+    assert(0 == events.back().second.value);
+  }
+
+  // A timed-out query records the timeout.
+  tracer.clear();
+  assert(tracer.events().empty());
+  {
+    BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, 0, V - 1, 0);
+    assert(-1 == solver.outcome());
+    std::vector<ThreadEvent> events = tracer.events();
+    assert(1 == count(events, kTraceTimeout));
+    assert(-1 == events.back().second.vertex);
+  }
+
+  // Sessions are traced too, one query at a time.
+  tracer.clear();
+  {
+    ShortestPathSession<int, CompactDirectedGraph> session(graph, 0);
+    session.query(V - 1, 10);
+    session.query(V / 2, 10);
+    std::vector<ThreadEvent> events = tracer.events();
+    assert(2 == count(events, kTraceQueryBegin));
+    assert(2 == count(events, kTraceQueryEnd));
+    assert(session.numStatesExplored() ==
+           static_cast<int>(events.back().second.count));
+  }
+
+  // So are the other solvers, nested searches included, as one query each.
+  tracer.clear();
+  {
+    AlternativeRouteSolver<int, CompactDirectedGraph> routes(graph, 0, 99, 2,
+                                                             10);
+    std::vector<ThreadEvent> events = tracer.events();
+    assert(1 == count(events, kTraceQueryBegin));
+    assert(routes.numStatesExplored() == count(events, kTraceSettle));
+    assert(routes.routeWeight(0) == events.back().second.value);
+  }
+  tracer.clear();
+  {
+    KShortestPathsSolver<int, CompactDirectedGraph> paths(graph, 0, 99, 3, 10);
+    std::vector<ThreadEvent> events = tracer.events();
+    assert(1 == count(events, kTraceQueryBegin));
+    assert(paths.numStatesExplored() == count(events, kTraceSettle));
+    assert(paths.pathWeight(0) == events.back().second.value);
+  }
+
+  // Sampling.
+  tracer.clear();
+  tracer.setSampling(3);
+  for (int q = 0; q < 9; q++)
+    BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, q, V - 1, 10);
+  assert(3 == count(tracer.events(), kTraceQueryBegin));
+  tracer.setSampling(1);
+
+  // A full ring buffer keeps the latest events. Buffers are per thread,
+  // so a new thread gets one of the new capacity.
+  tracer.clear();
+  tracer.setBufferCapacity(100);
+  std::thread small([&graph, V] {
+    BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, 0, V - 1, 10);
+  });
+  small.join();
+  {
+    std::vector<ThreadEvent> events = tracer.events();
+    assert(127 == events.size());
+    assert(kTraceQueryEnd == events.back().second.type);
+    for (size_t i = 1; i < events.size(); i++)
+      assert(events[i].second.time >= events[i - 1].second.time);
+  }
+  tracer.setBufferCapacity(1 << 16);
+
+  // Threads record concurrently, and can be read while they do.
+  tracer.clear();
+  const int kThreads = 4;
+  std::atomic<int> running(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.push_back(std::thread([&graph, &running, V, t] {
+      for (int q = 0; q < 20; q++)
+        BiDijkstraSolver<int, CompactDirectedGraph> solver(graph, q * t,
+                                                           V - 1 - q, 10);
+      running--;
+    }));
+  }
+  while (running > 0) {
+    for (auto& event : tracer.events()) {
+      assert(event.second.type <= kTraceQueryEnd);
+      assert(event.second.type != kTraceSettle ||
+             (event.second.vertex >= 0 && event.second.vertex < V));
+    }
+  }
+  for (auto& thread : threads)
+    thread.join();
+  std::vector<ThreadEvent> events = tracer.events();
+  assert(kThreads * 20 == count(events, kTraceQueryBegin));
+  assert(kThreads * 20 == count(events, kTraceQueryEnd));
+
+  // Binary export round trip.
+  std::vector<ThreadEvent> read;
+  assert(tracer.writeBinaryTrace("/tmp/test_searchtrace.bin"));
+  assert(SearchTracer::readBinaryTrace("/tmp/test_searchtrace.bin", &read));
+  assert(events.size() == read.size());
+  for (size_t i = 0; i < events.size(); i++) {
+    assert(events[i].first == read[i].first);
+    assert(events[i].second.time == read[i].second.time);
+    assert(events[i].second.vertex == read[i].second.vertex);
+    assert(events[i].second.value == read[i].second.value);
+    assert(events[i].second.query == read[i].second.query);
+    assert(events[i].second.count == read[i].second.count);
+    assert(events[i].second.type == read[i].second.type);
+    assert(events[i].second.forward == read[i].second.forward);
+  }
+  assert(!SearchTracer::readBinaryTrace("/nonexistent", &read));
+
+  // Chrome trace export: one slice per query, plus instant and counter
+  // events.
+  assert(tracer.writeChromeTrace("/tmp/test_searchtrace.json"));
+  std::ifstream file("/tmp/test_searchtrace.json");
+  std::stringstream json;
+  json << file.rdbuf();
+  std::string text = json.str();
+  int begins = 0, ends = 0, settles = 0, counters = 0;
+  for (size_t i = text.find("\"ph\":"); i != std::string::npos;
+       i = text.find("\"ph\":", i + 1)) {
+    char phase = text[i + 6];
+    begins += phase == 'B';
+    ends += phase == 'E';
+    counters += phase == 'C';
+  }
+  for (size_t i = text.find("\"settle\""); i != std::string::npos;
+       i = text.find("\"settle\"", i + 1))
+    settles++;
+  assert(text.front() == '{' && text.find("\n]}") != std::string::npos);
+  assert(kThreads * 20 == begins && kThreads * 20 == ends);
+  assert(count(events, kTraceSettle) == settles);
+  assert(settles == counters);
+  std::cout << "Events: " << events.size() << " from " << kThreads
+            << " threads, " << text.size() << " bytes of JSON" << std::endl;
+}